@@ -1,9 +1,19 @@
 #include <DHTxx.h>
 #include <ESP8266.h>
+#include <ESP8266Link.h>
+#include <DhtSensor.h>
+#include <Aggregator.h>
 #define DHT_PIN 7
 
 Dht dht(DHT_PIN, Dht::TypeEL::DHT11);
 ESP8266 esp(Serial);
+// probes the module and recovers the WiFi link when needed
+ESP8266Link link(esp);
+// temperature is channel 0, humidity is channel 1
+DhtSensor dhtSensor(dht, 0);
+// send data only when it changes, or at least every 10 minutes
+Aggregator aggregator(600000);
+unsigned long lastRead = 0;
 
 // WiFi authentication data
 const char* WIFI_SSID = "wotap";
@@ -18,19 +28,20 @@ const char* DATA_SERVER_API_KEY = "3LTES6V0ERPMDZ12";
 char* DATA_SERVER_PATH = "/api.thingspeak.com/update";
 const char DATA_TEMPLATE[] PROGMEM = "?api_key=%s&field1=%s&field2=%s";
 
-boolean checkWiFi() {
-  if( esp.at() == ESP8266::Error::NONE) return true; 
-  return false;
-};
-
 void setup() {  
   // Start serial communication, used to 
   // communicate with the ESP8266 WiFi module.
   Serial.begin(115200);
   // set the WiFi mode for the ESP8266 module
   esp.atCwmode(ESP8266::WiFiMode::STA);
-  // connect to WiFi network...try again and again
-  while (esp.atCwjap(WIFI_SSID, WIFI_PASSWORD) != ESP8266::Error::NONE);
+  // the WiFi network is joined by link.update (in loop),
+  // and joined again if the connection is lost
+  link.setAccessPoint(WIFI_SSID, WIFI_PASSWORD);
+  link.begin();
+  // report temperature changes bigger than 0.5 degrees
+  aggregator.setDeadband(0, 50);
+  // report humidity changes bigger than 2%
+  aggregator.setDeadband(1, 200);
 };
 
 void createDataFromTemplate( char *&data, float temperature, float humidity) {
@@ -50,22 +61,33 @@ void sendDataToServer(float temperature, float humidity) {
   char data[96] = {0};
   char *pData = data;
   createDataFromTemplate(pData, temperature, humidity);
-  esp.atCipstartTcp(DATA_SERVER_ADDRESS, 80);
-  esp.atCipsendHttpGet(DATA_SERVER_PATH, data);
+  // the send results are reported to the link supervisor: a failed
+  // send is detected faster than by waiting for the next probe
+  if (esp.atCipstartTcp(DATA_SERVER_ADDRESS, 80) == ESP8266::Error::NONE
+    && esp.atCipsendHttpGet(DATA_SERVER_PATH, data) == ESP8266::Error::NONE)
+    link.reportSuccess();
+  else link.reportFailure();
   esp.atCipclose();
 };
 
 void loop() {
-  // nothing to do if the WiFi module does not 
-  // responds to AT command...check the hardware! 
-  if (!checkWiFi()) return;
-  // read data from the DHT sensor
-  Dht::Result result = dht.read();
-  // if communication with the sensor was 
-  // succesful, we send data to thingspeak.com
-  if (result.status == Dht::StatusEL::OK) 
-    sendDataToServer(result.temperature, result.humidity);
-  // some delay until the next data sample 
-  // is read and transmitted to server
-  delay(5000);
+  Sensor::Sample samples[2];
+  Aggregator::Record record;
+  bool changed = false;
+  // probe the WiFi module, or run the next recovery step
+  link.update();
+  // read the sensor every 5 seconds, and only if 
+  // the data can be sent (the link is not down)
+  if (millis() - lastRead < 5000 || !link.isUp()) return;
+  lastRead = millis();
+  // read data from the DHT sensor (no samples if the sensor
+  // minimum interval did not pass since the last reading)
+  if (dhtSensor.read(samples) < 2) return;
+  // if communication with the sensor was succesful
+  // and the values changed enough (see the deadbands), 
+  // we send data to thingspeak.com
+  changed = aggregator.add(samples[0], record);
+  changed = aggregator.add(samples[1], record) || changed;
+  if (changed) 
+    sendDataToServer(samples[0].value / 100.0, samples[1].value / 100.0);
 };
@@ -1,4 +1,5 @@
 #include <ESP8266.h>
+#include <ESP8266Link.h>
 
 // WiFi authentication data
 const char* WIFI_SSID = "your-wifi-ssid";
@@ -12,6 +13,7 @@ char* SERVER_REGISTRATION_KEY = "team0";
 char* SERVER_DATA_POST_PATH = "/data/team0";
 
 ESP8266 esp(Serial);
+ESP8266Link link(esp);
 SoftwareSerial debug(10, 11);
 
 void setup() {
@@ -24,13 +26,18 @@ void setup() {
   delay(1000);
 
   // software reset the ESP8266 WiFi module
-  while(esp.atRst() != ESP8266::Error::NONE);
-  // check if WiFi module is active
-  while(esp.at() != ESP8266::Error::NONE);  
+  esp.atRst();
   // set station mode for WiFi module
   esp.atCwmode(ESP8266::WiFiMode::STA);
-  // wait to connect to WiFi network
-  while(esp.atCwjap(WIFI_SSID, WIFI_PASSWORD) != ESP8266::Error::NONE);
+  // connect to WiFi network: the link supervisor retries with 
+  // increasing delays, resets the module if it does not answer,
+  // and gives up after one minute
+  link.setAccessPoint(WIFI_SSID, WIFI_PASSWORD);
+  link.begin();
+  if (!link.waitUp(60000)) {
+    debug.println("WiFi connection failed!");
+    return;
+  }
   
   // register to data server
   esp.atCipstartTcp(SERVER_ADDRESS, 80);
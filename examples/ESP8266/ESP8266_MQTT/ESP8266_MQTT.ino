@@ -0,0 +1,68 @@
+#include <DHTxx.h>
+#include <ESP8266.h>
+#include <ESP8266Mqtt.h>
+#include <ESP8266Link.h>
+#include <DhtSensor.h>
+#define DHT_PIN 7
+
+Dht dht(DHT_PIN, Dht::TypeEL::DHT22);
+ESP8266 esp(Serial);
+// keep alive: 60 seconds
+ESP8266Mqtt mqtt(esp, "node1", 60);
+// probes the module and recovers the WiFi link when needed 
+// (the broker connection is recovered by ESP8266Mqtt)
+ESP8266Link link(esp);
+// temperature is channel 0, humidity is channel 1
+DhtSensor dhtSensor(dht, 0);
+unsigned long lastRead = 0;
+
+// WiFi authentication data
+const char* WIFI_SSID = "wotap";
+const char* WIFI_PASSWORD = "g3ma4ode";
+
+// MQTT broker address
+const char* BROKER_ADDRESS = "192.168.1.10";
+
+void setup() {  
+  // Start serial communication, used to 
+  // communicate with the ESP8266 WiFi module.
+  Serial.begin(115200);
+  // disable ECHO
+  esp.ate0();
+  // set the WiFi mode for the ESP8266 module
+  esp.atCwmode(ESP8266::WiFiMode::STA);
+  // the WiFi network is joined by link.update (in loop),
+  // and joined again if the connection is lost
+  link.setAccessPoint(WIFI_SSID, WIFI_PASSWORD);
+  link.begin();
+  mqtt.setBroker(BROKER_ADDRESS, 1883);
+  // the topics are "home/node1/t" and "home/node1/h"
+  mqtt.setTopicPrefix("home/node1/");
+};
+
+void loop() {
+  Sensor::Sample samples[2];
+  char payload[8] = {0};
+  ESP8266Mqtt::Error error = ESP8266Mqtt::Error::NONE;
+  uint32_t packets = 0;
+  // probe the WiFi module, or run the next recovery step
+  if (link.update() == ESP8266Link::State::DOWN) return;
+  // keep alive, and reconnect if the connection was lost
+  packets = mqtt.getPackets();
+  error = mqtt.update();
+  if (error == ESP8266Mqtt::Error::TIMEOUT || error == ESP8266Mqtt::Error::LINK)
+    link.reportFailure();
+  // a received packet (e.g., PINGRESP) proves that the link is up
+  else if (mqtt.getPackets() != packets) link.reportSuccess();
+  if (!mqtt.isConnected() || millis() - lastRead < 10000) return;
+  lastRead = millis();
+  dhtSensor.read(samples);
+  if (samples[0].status != Sensor::StatusEL::OK) return;
+  // values are in hundredths, publish tenths
+  dtostrf(samples[0].value / 100.0, 0, 1, payload);
+  mqtt.publish("t", payload);
+  dtostrf(samples[1].value / 100.0, 0, 1, payload);
+  // QoS 1: wait for the broker acknowledgement (PUBACK)
+  if (mqtt.publish("h", payload, ESP8266Mqtt::QoS::AT_LEAST_ONCE) == ESP8266Mqtt::Error::NONE)
+    link.reportSuccess();
+};
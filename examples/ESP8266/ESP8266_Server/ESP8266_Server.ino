@@ -0,0 +1,72 @@
+#include <DHTxx.h>
+#include <ESP8266.h>
+#include <ESP8266Server.h>
+#include <ESP8266Link.h>
+#include <DhtSensor.h>
+#define DHT_PIN 7
+
+Dht dht(DHT_PIN, Dht::TypeEL::DHT22);
+ESP8266 esp(Serial);
+ESP8266Server server(esp);
+// probes the module and recovers the WiFi link when needed
+ESP8266Link link(esp);
+// temperature is channel 0, humidity is channel 1
+DhtSensor dhtSensor(dht, 0);
+// published values: hundredths of degree and of %RH
+char temperatureIndex = -1, humidityIndex = -1;
+unsigned long lastRead = 0;
+
+// WiFi authentication data
+const char* WIFI_SSID = "wotap";
+const char* WIFI_PASSWORD = "g3ma4ode";
+
+// configure the module and start the server on port 80
+// (also called after a module reset, see setup)
+void startServer() {
+  // disable ECHO
+  esp.ate0();
+  server.begin(80);
+};
+
+void setup() {  
+  // Start serial communication, used to 
+  // communicate with the ESP8266 WiFi module.
+  Serial.begin(115200);
+  // set the WiFi mode for the ESP8266 module
+  esp.atCwmode(ESP8266::WiFiMode::STA);
+  temperatureIndex = server.add("temperature", 2);
+  humidityIndex = server.add("humidity", 2);
+  startServer();
+  // the WiFi network is joined by link.update (in loop), and joined
+  // again if the connection is lost. The server mode is lost after a
+  // module reset, so it is started again by the reset handler.
+  link.setAccessPoint(WIFI_SSID, WIFI_PASSWORD);
+  link.setResetHandler(startServer);
+  link.begin();
+};
+
+void loop() {
+  Sensor::Sample samples[2];
+  // read the sensor every 5 seconds (the cache
+  // is rendered again only if the values changed)
+  if (millis() - lastRead > 5000) {
+    lastRead = millis();
+    dhtSensor.read(samples);
+    if (samples[0].status == Sensor::StatusEL::OK) {
+      server.set(temperatureIndex, samples[0].value);
+      server.set(humidityIndex, samples[1].value);
+    }
+  }
+  // probe the WiFi module, or run the next recovery step
+  if (link.update() == ESP8266Link::State::DOWN) return;
+  // answer the pending client request, if any, e.g.:
+  //   curl http://<module IP>/
+  //   or, with a TCP connection: echo READ | nc <module IP> 80
+  uint32_t requests = server.getRequests(), responses = server.getResponses();
+  ESP8266Server::Error error = server.update();
+  // a received request or a sent response proves that the link 
+  // is up (so the link is not probed while clients use it)
+  if (server.getRequests() != requests || server.getResponses() != responses)
+    link.reportSuccess();
+  else if (error == ESP8266Server::Error::TIMEOUT) link.reportFailure();
+};
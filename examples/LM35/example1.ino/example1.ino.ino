@@ -1,21 +1,29 @@
+#include <AnalogSampler.h>
+#include <LM35.h>
 #define LM35DZ_PIN A0
 
+AnalogSampler sampler;
+char lm35Channel = -1;
+
 void setup() {
   Serial.begin(115200);
+  // 2 extra bits of resolution: 12 bits values,
+  // each one obtained from 16 samples
+  lm35Channel = sampler.add(LM35DZ_PIN, 2);
+  sampler.begin();
   delay(1000);
 }
 
 void loop() {
-  uint8_t i = 0;
-  uint16_t adcUnits = 0;
-  float temperature  = 0;
-  for (i = 0; i < 9; i++) {
-    adcUnits = analogRead(LM35DZ_PIN);
-    temperature += adcUnits * 0.00488 * 100;
-  }
-  temperature /= 10;
+  // average of the latest values, sampled in background,
+  // converted to hundredths of Celsius degree
+  int16_t temperature = LM35::toCentiCelsius(
+    sampler.read(lm35Channel), sampler.getResolution(lm35Channel));
   Serial.print("Temperature: ");
-  Serial.println(temperature);
+  Serial.print(temperature / 100);
+  Serial.print('.');
+  if (temperature % 100 < 10) Serial.print('0');
+  Serial.println(temperature % 100);
 
   delay(5000);
 }
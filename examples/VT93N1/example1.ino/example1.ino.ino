@@ -1,27 +1,26 @@
+#include <AnalogSampler.h>
+#include <VT93N1.h>
 #define VT93N1_PIN A1
 
+AnalogSampler sampler;
+char vt93n1Channel = -1;
+
 void setup() {
   Serial.begin(115200);
+  vt93n1Channel = sampler.add(VT93N1_PIN);
+  sampler.begin();
   delay(1000);
 }
 
 void loop() {
-  double vAcrossR2 = 0, r1 = 0, luxValue = 0,
-         vInput = 5, r2 = 10000;
-  
-  // collect 10 samples and average to obtain stable value.
-  for ( byte i = 0; i < 10; i++) {
-    // read voltage from pin, in Volts
-    vAcrossR2 += analogRead(VT93N1_PIN) * 0.00488;
-  }
-  vAcrossR2 = vAcrossR2 / 10.0;
-
-  // calculate resistance r1 = 22 * (vInput / vAcrossR1 - 1)
-  r1 = r2 * ( vInput / vAcrossR2 - 1);
+  // average of the latest values, sampled in background
+  uint16_t adcUnits = sampler.read(vt93n1Channel);
 
-  // convert resistance value to LUX value for this sensor based in formula:
+  // convert the voltage across R2 to LUX value, by using the lookup
+  // table computed (at compile time) from the sensor formula:
   // E = 341.64 / R^(10 / 9), where R is measured in kOhm
-  luxValue = 341.64 / pow( r1 / 1000.0, 10.0 / 9.0);
+  // The divider (R2 = 10KOhm, 5V) is configured in VT93N1.h
+  uint16_t luxValue = VT93N1::toLux(adcUnits);
 
   Serial.print("LUX: ");
   Serial.println(luxValue);
@@ -0,0 +1,75 @@
+/*
+ * Micro-benchmark runner for the host build. Every benchmark is run
+ * a few times, and the best and the median time per operation are
+ * kept, so the results of different commits can be compared.
+ *
+ * @file Bench.h
+ * @version 1.0
+ */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// number of runs of every benchmark
+#define BENCH_RUNS 7
+
+// results sink: prevents the compiler from removing the benchmarked code
+extern volatile uint32_t benchSink;
+
+class Bench {
+  public:
+    struct Result {
+      std::string name;
+      uint32_t iterations;
+      double bestNs;
+      double medianNs;
+    };
+    /**
+     * Run a benchmark and store its result.
+     * @param name
+     *          the benchmark name, e.g., "util.getPMData"
+     * @param iterations
+     *          number of operations for every run
+     * @param operation
+     *          the benchmarked operation (a function or a lambda)
+     * @return the best time per operation, in nanoseconds
+     */
+    template <class Operation>
+    double run(const char *name, uint32_t iterations, Operation operation) {
+      std::vector<double> times;
+      for (uint8_t r = 0; r < BENCH_RUNS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) operation();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(
+          end - start).count() / iterations);
+      }
+      std::sort(times.begin(), times.end());
+      this->results.push_back(
+        Result{name, iterations, times[0], times[BENCH_RUNS / 2]});
+      printf("%-32s %10.1f ns/op (median %.1f)\n",
+        name, times[0], times[BENCH_RUNS / 2]);
+      return times[0];
+    };
+    /**
+     * Check a benchmark precondition (e.g., the parsed data is right),
+     * so a broken code path is reported instead of being measured.
+     */
+    void check(const char *name, bool condition) {
+      if (condition) return;
+      printf("CHECK FAILED: %s\n", name);
+      this->failed++;
+    };
+    bool write(const char *path, const char *commit);
+    uint16_t getFailed() { return this->failed; };
+  private:
+    std::vector<Result> results;
+    uint16_t failed = 0;
+};
+#endif
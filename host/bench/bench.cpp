@@ -0,0 +1,913 @@
+/*
+ * Micro-benchmarks for the hot paths of the libraries (host build).
+ *
+ * Usage: bench [-o results.json] [-c commit]
+ * The results (best and median ns per operation) are printed and, if
+ * requested, written as JSON, so they can be tracked for every commit.
+ * NOTE: the host CPU has a FPU and caches, so the numbers show the
+ *       relative cost and the regressions, not the AVR cycle counts.
+ */
+#include <Arduino.h>
+#include <ESP8266.h>
+#include <ESP8266Server.h>
+#include <ESP8266Mqtt.h>
+#include <ESP8266Link.h>
+#include <UartStream.h>
+#include <SIM900.h>
+#include <DHTxx.h>
+#include <DhtCache.h>
+#include <HCSR04.h>
+#include <LM35.h>
+#include <VT93N1.h>
+#include <SampleCodec.h>
+#include <Aggregator.h>
+#include "Bench.h"
+
+#define DHT_PIN 7
+#define TRIGGER_PIN 6
+#define ECHO_PIN 5
+// echo duration of an obstacle at 200mm
+#define ECHO_200MM 1166
+
+volatile uint32_t benchSink = 0;
+
+const char BENCH_PGM_DATA[] PROGMEM =
+  "Content-Type: application/x-www-form-urlencoded";
+
+/**
+ * Simulated DHT22 answer: the "ready" response, then the 40 bits data
+ * stream (55.3%, -10.1C), as a list of pin level changes (in micros,
+ * relative to the switch of the pin to INPUT by the driver).
+ */
+static const uint8_t DHT_DATA[5] = {0x02, 0x29, 0x80, 0x65, 0x10};
+static unsigned long dhtEdges[2 * 40 + 4];
+static uint8_t dhtEdgesCount = 0;
+
+static void dhtSetup() {
+  unsigned long t = 30;
+  // the sensor pulls the pin down (80us), then up (80us)
+  dhtEdges[dhtEdgesCount++] = t;
+  dhtEdges[dhtEdgesCount++] = t += 80;
+  t += 80;
+  for (uint8_t i = 0; i < 40; i++) {
+    // every bit: 50us LOW, then 26us (0) or 70us (1) HIGH
+    bool one = DHT_DATA[i / 8] & (0x80 >> (i % 8));
+    dhtEdges[dhtEdgesCount++] = t;
+    dhtEdges[dhtEdgesCount++] = t += 50;
+    t += one ? 70 : 26;
+  }
+  // the end of the data stream: 50us LOW, then the pin is released
+  dhtEdges[dhtEdgesCount++] = t;
+  dhtEdges[dhtEdgesCount++] = t + 50;
+};
+
+static int dhtDigitalRead(uint8_t pin) {
+  static unsigned long start = 0;
+  static uint8_t edge = 0;
+  if (pin != DHT_PIN) return LOW;
+  // a new data request: start again from the first edge
+  if (hostPinModeTime(pin) != start) {
+    start = hostPinModeTime(pin);
+    edge = 0;
+  }
+  // the pin level changes at every edge, and it is HIGH before the first
+  while (edge < dhtEdgesCount && hostTime() - start >= dhtEdges[edge]) edge++;
+  return (edge & 1) ? LOW : HIGH;
+};
+
+static unsigned long hcsr04PulseIn(uint8_t pin, uint8_t state,
+  unsigned long timeout) {
+  (void)pin; (void)state; (void)timeout;
+  return ECHO_200MM;
+};
+
+// echo at exactly the configured maximum range
+static unsigned long hcsr04MaxRangePulseIn(uint8_t pin, uint8_t state,
+  unsigned long timeout) {
+  (void)pin; (void)state;
+  return timeout - HCSR04_ECHO_START_TIMEOUT;
+};
+
+static void benchUtil(Bench &bench) {
+  char buffer[64];
+  char *data = buffer;
+  uint8_t length = 0;
+  getPMData(BENCH_PGM_DATA, data, length);
+  bench.check("util.getPMData", length == strlen(BENCH_PGM_DATA));
+  bench.run("util.getPMData", 200000, [&]() {
+    getPMData(BENCH_PGM_DATA, data, length);
+    benchSink += length;
+  });
+  uint16_t value = 0;
+  bench.run("util.getDigitsCount", 1000000, [&]() {
+    benchSink += getDigitsCount(value++);
+  });
+};
+
+static void benchEsp8266(Bench &bench) {
+  HostStream modem;
+  ESP8266 esp(modem);
+  char buffer[64];
+  char *data = buffer;
+  uint16_t dataLen = 0;
+  ESP8266::LinkId linkId = ESP8266::LinkId::NONE;
+  ESP8266::Error error = ESP8266::Error::NONE;
+
+  // +IPD frame parsing
+  modem.feed("+IPD,12:hello world!");
+  error = esp.ipd(data, dataLen, linkId);
+  bench.check("esp8266.ipd", error == ESP8266::Error::NONE
+    && dataLen == 12 && strcmp(buffer, "hello world!") == 0);
+  bench.run("esp8266.ipd", 100000, [&]() {
+    modem.feed("+IPD,12:hello world!");
+    esp.ipd(data, dataLen, linkId);
+    benchSink += dataLen;
+  });
+  modem.feed("+IPD,3,22:temperature=21.5&id=17");
+  error = esp.ipd(data, dataLen, linkId);
+  bench.check("esp8266.ipd.mux", error == ESP8266::Error::NONE
+    && dataLen == 22 && linkId == ESP8266::LinkId::ID_3);
+  bench.run("esp8266.ipd.mux", 100000, [&]() {
+    modem.feed("+IPD,3,22:temperature=21.5&id=17");
+    esp.ipd(data, dataLen, linkId);
+    benchSink += dataLen;
+  });
+
+  // send path: the command, the '>' prompt, the data and SEND OK
+  modem.reply("AT+CIPSEND", "\r\nOK\r\n> \r\nSEND OK\r\n");
+  char path[] = "/data/team0";
+  char values[] = "temperature=21.5&humidity=55.3";
+  modem.clearOutput();
+  error = esp.atCipsend(values);
+  // exactly the announced bytes are sent (no \0, no line end)
+  bench.check("esp8266.atCipsend", error == ESP8266::Error::NONE
+    && modem.getOutput() == std::string("AT+CIPSEND=30\r\n") + values);
+  bench.run("esp8266.atCipsend", 50000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)esp.atCipsend(values);
+  });
+  error = esp.atCipsendHttpGet(path, values);
+  bench.check("esp8266.atCipsendHttpGet", error == ESP8266::Error::NONE);
+  bench.run("esp8266.atCipsendHttpGet", 50000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)esp.atCipsendHttpGet(path, values);
+  });
+  error = esp.atCipsendHttpPost(path, values);
+  bench.check("esp8266.atCipsendHttpPost", error == ESP8266::Error::NONE);
+  bench.run("esp8266.atCipsendHttpPost", 50000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)esp.atCipsendHttpPost(path, values);
+  });
+};
+
+/**
+ * MQTT broker stand-in: answers the packets sent by the client (the
+ * AT+CIPSEND data) with +IPD frames: CONNECT with CONNACK, QoS 1
+ * PUBLISH with PUBACK (same packet identifier), PINGREQ with PINGRESP.
+ */
+static struct {
+  uint8_t returnCode;
+  bool answerPing;
+  uint16_t packets[16];
+  // the last PUBLISH topic and payload
+  std::string topic;
+  std::string payload;
+} broker;
+
+static void brokerFeed(HostStream &stream, const uint8_t *packet,
+  uint8_t length) {
+  char header[16];
+  snprintf(header, sizeof(header), "\r\n+IPD,%u:", length);
+  stream.feed(header);
+  stream.feed(packet, length);
+};
+
+static void brokerData(HostStream &stream, const std::string &data) {
+  const uint8_t *packet = (const uint8_t*)data.data();
+  uint8_t type = packet[0] >> 4, qos = (packet[0] >> 1) & 0x03;
+  size_t pos = 1, remainingLen = 0, topicLen = 0;
+  uint8_t shift = 0;
+  do {
+    remainingLen |= (packet[pos] & 0x7F) << shift;
+    shift += 7;
+  } while (packet[pos++] & 0x80);
+  if (pos + remainingLen != data.size()) return;
+  broker.packets[type]++;
+  if (type == ESP8266_MQTT_CONNECT) {
+    const uint8_t connack[] = {0x20, 0x02, 0x00, broker.returnCode};
+    brokerFeed(stream, connack, sizeof(connack));
+  } else if (type == ESP8266_MQTT_PUBLISH) {
+    topicLen = (packet[pos] << 8) | packet[pos + 1];
+    broker.topic = data.substr(pos + 2, topicLen);
+    pos += 2 + topicLen;
+    if (qos == 1) {
+      const uint8_t puback[] = {0x40, 0x02, packet[pos], packet[pos + 1]};
+      brokerFeed(stream, puback, sizeof(puback));
+      pos += 2;
+    }
+    broker.payload = data.substr(pos);
+  } else if (type == ESP8266_MQTT_PINGREQ && broker.answerPing) {
+    const uint8_t pingresp[] = {0xD0, 0x00};
+    brokerFeed(stream, pingresp, sizeof(pingresp));
+  }
+};
+
+static void benchEsp8266Mqtt(Bench &bench) {
+  HostStream modem;
+  ESP8266 esp(modem);
+  ESP8266Mqtt mqtt(esp, "node1", 10);
+  ESP8266Mqtt::Error error = ESP8266Mqtt::Error::NONE;
+  uint32_t bytesSent = 0;
+  size_t uartBytes = 0;
+  char path[] = "/data/node1";
+  char values[] = "t=21.5";
+  modem.reply("AT+CIPSTART", "\r\nCONNECT\r\n\r\nOK\r\n");
+  modem.reply("AT+CIPCLOSE", "\r\nCLOSED\r\n\r\nOK\r\n");
+  modem.reply("AT+CIPSEND", "\r\nOK\r\n> \r\nSEND OK\r\n");
+  modem.setDataHandler(brokerData);
+  mqtt.setBroker("broker.local");
+  mqtt.setTopicPrefix("home/node1/");
+
+  // a refused connection, then an accepted one
+  broker.returnCode = 5;
+  bench.check("esp8266.mqtt.connect.refused",
+    mqtt.connect() == ESP8266Mqtt::Error::REFUSED && !mqtt.isConnected()
+    && mqtt.getReturnCode() == 5);
+  broker.returnCode = 0;
+  bench.check("esp8266.mqtt.connect",
+    mqtt.connect() == ESP8266Mqtt::Error::NONE && mqtt.isConnected()
+    && broker.packets[ESP8266_MQTT_CONNECT] == 2);
+
+  // QoS 0 and QoS 1 PUBLISH: the broker gets the full topic and payload
+  bytesSent = mqtt.getBytesSent();
+  error = mqtt.publish("t", "21.5");
+  bench.check("esp8266.mqtt.publish.qos0", error == ESP8266Mqtt::Error::NONE
+    && broker.topic == "home/node1/t" && broker.payload == "21.5");
+  printf("%-32s %u bytes/sample\n", "esp8266.mqtt.bytes.qos0",
+    mqtt.getBytesSent() - bytesSent);
+  bytesSent = mqtt.getBytesSent();
+  error = mqtt.publish("h", "55.3", ESP8266Mqtt::QoS::AT_LEAST_ONCE);
+  bench.check("esp8266.mqtt.publish.qos1", error == ESP8266Mqtt::Error::NONE
+    && mqtt.getAcked() == 1 && broker.topic == "home/node1/h"
+    && broker.payload == "55.3");
+  printf("%-32s %u bytes/sample\n", "esp8266.mqtt.bytes.qos1",
+    mqtt.getBytesSent() - bytesSent);
+  // the same value, as HTTP POST request (TCP payload: the announced
+  // AT+CIPSEND length; UART: all the bytes sent to the module)
+  modem.setDataHandler(0);
+  modem.clearOutput();
+  esp.atCipsendHttpPost(path, values);
+  uartBytes = modem.getOutput().size();
+  printf("%-32s %ld bytes/sample (UART %u)\n", "esp8266.http.bytes.post",
+    atol(modem.getOutput().c_str() + 11), (unsigned)uartBytes);
+  modem.setDataHandler(brokerData);
+
+  // keep alive: PINGREQ after 3/4 of the interval, PINGRESP in time
+  broker.answerPing = true;
+  hostAdvanceTime(7600000UL);
+  mqtt.update();
+  mqtt.update();
+  hostAdvanceTime((ESP8266_MQTT_ACK_TIMEOUT + 1) * 1000UL);
+  bench.check("esp8266.mqtt.keepAlive",
+    mqtt.update() == ESP8266Mqtt::Error::NONE && mqtt.isConnected()
+    && broker.packets[ESP8266_MQTT_PINGREQ] == 1);
+  // no PINGRESP: the connection is lost
+  broker.answerPing = false;
+  hostAdvanceTime(7600000UL);
+  mqtt.update();
+  hostAdvanceTime((ESP8266_MQTT_ACK_TIMEOUT + 1) * 1000UL);
+  bench.check("esp8266.mqtt.keepAlive.timeout",
+    mqtt.update() == ESP8266Mqtt::Error::TIMEOUT && !mqtt.isConnected());
+  mqtt.connect();
+
+  bench.run("esp8266.mqtt.publish.qos0", 50000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)mqtt.publish("t", "21.5");
+  });
+  bench.run("esp8266.mqtt.publish.qos1", 50000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)mqtt.publish("t", "21.5",
+      ESP8266Mqtt::QoS::AT_LEAST_ONCE);
+  });
+  bench.check("esp8266.mqtt.errors", mqtt.isConnected()
+    && mqtt.getAcked() == mqtt.getPublished() - 50000 * BENCH_RUNS - 1);
+};
+
+/**
+ * The link probe (AT) skips the received data until its OK, so it must
+ * wait until the sketch read the pending +IPD frames.
+ */
+static void benchEsp8266Link(Bench &bench) {
+  HostStream modem;
+  ESP8266 esp(modem);
+  ESP8266Link link(esp);
+  char buffer[64];
+  char *data = buffer;
+  uint16_t dataLen = 0;
+  ESP8266::LinkId linkId = ESP8266::LinkId::NONE;
+  bool probed = false;
+
+  modem.reply("AT", "\r\nOK\r\n");
+  // a probe is due, but a +IPD frame was received
+  hostAdvanceTime((ESP8266_LINK_PROBE_INTERVAL + 1) * 1000UL);
+  modem.feed("+IPD,12:hello world!");
+  link.update();
+  probed = !modem.getOutput().empty();
+  bench.check("esp8266.link.pending", !probed
+    && esp.ipd(data, dataLen, linkId) == ESP8266::Error::NONE
+    && dataLen == 12 && strcmp(buffer, "hello world!") == 0);
+  // the frame was read, so the probe is sent
+  link.update();
+  bench.check("esp8266.link.probe", modem.getOutput() == "AT\r\n"
+    && link.getState() == ESP8266Link::State::UP);
+  // data never read by the sketch does not stop the probes
+  modem.clearOutput();
+  hostAdvanceTime((ESP8266_LINK_PROBE_INTERVAL + 1) * 1000UL);
+  modem.feed("+IPD,5:hello");
+  link.update();
+  probed = !modem.getOutput().empty();
+  hostAdvanceTime(ESP8266_LINK_INPUT_WAIT * 1000UL);
+  link.update();
+  bench.check("esp8266.link.unread", !probed
+    && modem.getOutput() == "AT\r\n"
+    && link.getState() == ESP8266Link::State::UP);
+};
+
+/**
+ * ESP8266T<UartStream<>> (final transport: direct calls) compared with
+ * ESP8266T<Stream> (virtual calls), on the same UartStream with
+ * in-memory USART registers: the received bytes are stored by the RX
+ * interrupt routine (called by uartFeed), the sent ones go to UDR.
+ */
+typedef UartStream<256> BenchUart;
+// UBRRH, UBRRL, UCSRA, UCSRB, UCSRC and UDR
+static volatile uint8_t usart[6];
+
+static void uartFeed(BenchUart &uart, const char *data) {
+  while (*data) {
+    usart[5] = *data++;
+    uart.rxInterrupt();
+  }
+};
+
+static void benchUartStream(Bench &bench) {
+  BenchUart uart(&usart[0], &usart[1], &usart[2], &usart[3], &usart[4],
+    &usart[5]);
+  ESP8266T<BenchUart> espFinal(uart);
+  ESP8266 espStream(uart);
+  char buffer[128];
+  char *data = buffer;
+  uint8_t payload[64];
+  uint16_t dataLen = 0;
+  ESP8266::LinkId linkId = ESP8266::LinkId::NONE;
+  ESP8266T<BenchUart>::LinkId finalLinkId = ESP8266T<BenchUart>::LinkId::NONE;
+  const char frame[] = "+IPD,64:"
+    "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+  const char sendReply[] = "\r\nOK\r\n> \r\nSEND OK\r\n";
+  double finalNs = 0, streamNs = 0;
+  // the transmit buffer is always empty
+  usart[2] = _BV(UDRE0);
+  for (uint8_t i = 0; i < sizeof(payload); i++) payload[i] = i;
+
+  uartFeed(uart, frame);
+  bench.check("esp8266.uart.ipd", espFinal.ipd(data, dataLen, finalLinkId)
+    == ESP8266::Error::NONE && dataLen == 64 && uart.getLost() == 0);
+  uartFeed(uart, sendReply);
+  bench.check("esp8266.uart.atCipsend", espFinal.atCipsend(payload,
+    sizeof(payload)) == ESP8266::Error::NONE && usart[5] == 63);
+  // both runs include the same RX interrupt routine calls
+  streamNs = bench.run("esp8266.uart.ipd.stream", 100000, [&]() {
+    uartFeed(uart, frame);
+    espStream.ipd(data, dataLen, linkId);
+    benchSink += dataLen;
+  });
+  finalNs = bench.run("esp8266.uart.ipd.final", 100000, [&]() {
+    uartFeed(uart, frame);
+    espFinal.ipd(data, dataLen, finalLinkId);
+    benchSink += dataLen;
+  });
+  printf("%-32s %10.2fx\n", "esp8266.uart.ipd.speedup", streamNs / finalNs);
+  streamNs = bench.run("esp8266.uart.atCipsend.stream", 100000, [&]() {
+    uartFeed(uart, sendReply);
+    benchSink += (uint8_t)espStream.atCipsend(payload, sizeof(payload));
+  });
+  finalNs = bench.run("esp8266.uart.atCipsend.final", 100000, [&]() {
+    uartFeed(uart, sendReply);
+    benchSink += (uint8_t)espFinal.atCipsend(payload, sizeof(payload));
+  });
+  printf("%-32s %10.2fx\n", "esp8266.uart.atCipsend.speedup",
+    streamNs / finalNs);
+
+  // flush waits for TXC only after a write (TXC is never set otherwise),
+  // and write clears TXC by writing 1 to it, keeping U2X and MPCM
+  BenchUart idle(&usart[0], &usart[1], &usart[2], &usart[3], &usart[4],
+    &usart[5]);
+  usart[2] = _BV(UDRE0) | _BV(U2X0) | _BV(FE0);
+  idle.flush();
+  idle.write('x');
+  bench.check("esp8266.uart.flush", usart[5] == 'x'
+    && usart[2] == (_BV(UDRE0) | _BV(U2X0) | _BV(TXC0)));
+  idle.flush();
+};
+
+static void benchEsp8266Server(Bench &bench) {
+  HostStream modem;
+  ESP8266 esp(modem);
+  ESP8266Server server(esp);
+  modem.reply("AT+CIPSEND", "\r\nOK\r\n> \r\nSEND OK\r\n");
+  modem.reply("AT+CIPCLOSE", "\r\n0,CLOSED\r\n\r\nOK\r\n");
+  modem.reply("AT", "\r\nOK\r\n");
+  bench.check("esp8266.server.begin",
+    server.begin() == ESP8266Server::Error::NONE);
+  char temperature = server.add("temperature", 1);
+  char humidity = server.add("humidity", 1);
+  server.set(temperature, 215);
+  server.set(humidity, 553);
+  const char get[] = "+IPD,0,18:GET / HTTP/1.1\r\n\r\n";
+  const char line[] = "+IPD,1,6:READ\r\n";
+  int32_t value = 0;
+
+  modem.feed(get);
+  server.update();
+  bench.check("esp8266.server.get",
+    modem.getOutput().find("200 OK") != std::string::npos);
+  // cached response: no value changed since the last request
+  bench.run("esp8266.server.get.cached", 20000, [&]() {
+    modem.clearOutput();
+    modem.feed(get);
+    benchSink += (uint8_t)server.update();
+  });
+  // a value changed before every request: the response is rendered
+  bench.run("esp8266.server.get.render", 20000, [&]() {
+    modem.clearOutput();
+    server.set(temperature, value++);
+    modem.feed(get);
+    benchSink += (uint8_t)server.update();
+  });
+  bench.run("esp8266.server.line.render", 20000, [&]() {
+    modem.clearOutput();
+    server.set(temperature, value++);
+    modem.feed(line);
+    benchSink += (uint8_t)server.update();
+  });
+  bench.check("esp8266.server.errors", server.getErrors() == 0);
+
+  // the client connection lines are dropped at once, and are not errors
+  uint32_t requests = server.getRequests();
+  unsigned long start = millis();
+  bool dropped = true;
+  modem.clearOutput();
+  modem.feed("0,CONNECT\r\n");
+  dropped = dropped && server.update() == ESP8266Server::Error::NONE;
+  modem.feed("\r\n1,CLOSED\r\n");
+  dropped = dropped && server.update() == ESP8266Server::Error::NONE;
+  bench.check("esp8266.server.connect", dropped && modem.available() == 0
+    && millis() - start < 10 && server.getErrors() == 0
+    && server.getRequests() == requests && modem.getOutput().empty());
+  modem.feed("2,CONNECT\r\n+IPD,2,6:READ\r\n");
+  bench.check("esp8266.server.connect.request",
+    server.update() == ESP8266Server::Error::NONE
+    && server.getRequests() == requests + 1
+    && modem.getOutput().find("temperature=") != std::string::npos);
+  // no values: nothing is sent for a LINE request
+  ESP8266Server empty(esp);
+  modem.clearOutput();
+  modem.feed(line);
+  bench.check("esp8266.server.line.empty",
+    empty.update() == ESP8266Server::Error::NONE
+    && empty.getErrors() == 0 && modem.getOutput().empty());
+};
+
+/**
+ * SIM900 against the modem emulator: open the GPRS session, post a
+ * batch (the announced AT+CIPSEND length must be the number of bytes
+ * written after it), then close the connection and the session.
+ */
+static void sim900Replies(HostStream &modem) {
+  modem.reply("AT+CIPSHUT", "\r\nSHUT OK\r\n");
+  modem.reply("AT+CGATT", "\r\nOK\r\n");
+  modem.reply("AT+CSTT", "\r\nOK\r\n");
+  modem.reply("AT+CIICR", "\r\nOK\r\n");
+  modem.reply("AT+CIFSR", "\r\n10.64.12.7\r\n");
+  modem.reply("AT+CIPSTART", "\r\nOK\r\n\r\nCONNECT OK\r\n");
+  modem.reply("AT+CIPSEND", "> \r\nSEND OK\r\n");
+  modem.reply("AT+CIPCLOSE", "\r\nCLOSE OK\r\n");
+};
+
+// the commands written since the last clearOutput call, in this order
+static bool sim900Sent(HostStream &modem, const char *commands[],
+  uint8_t count) {
+  size_t position = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    position = modem.getOutput().find(commands[i], position);
+    if (position == std::string::npos) return false;
+  }
+  return true;
+};
+
+// the AT+CIPSEND length is the length of the data written after it
+static bool sim900CipsendLength(HostStream &modem) {
+  const std::string &output = modem.getOutput();
+  size_t command = output.find("AT+CIPSEND=");
+  if (command == std::string::npos) return false;
+  size_t data = output.find("\r\n", command) + 2;
+  size_t end = output.find("AT+CIPCLOSE", data);
+  if (end == std::string::npos) return false;
+  return end - data == (size_t)atol(output.c_str() + command + 11);
+};
+
+static void benchSim900(Bench &bench) {
+  HostStream modem;
+  SIM900 sim900(modem);
+  uint8_t batch[40];
+  const char *session[] = {"AT+CIPSHUT", "AT+CGATT=1", "AT+CSTT=\"apn\"",
+    "AT+CIICR", "AT+CIFSR"};
+  const char *post[] = {"AT+CIPSTART=\"TCP\",\"example.com\",\"80\"",
+    "AT+CIPSEND=", "POST /batch HTTP/1.1", "Content-Length: 40",
+    "AT+CIPCLOSE"};
+  // a binary batch: all the byte values, including 0 and Ctrl+Z
+  for (uint8_t i = 0; i < sizeof(batch); i++) batch[i] = i;
+  sim900Replies(modem);
+
+  bench.check("sim900.openSession",
+    sim900.openSession("apn") == SIM900::Error::NONE
+    && sim900.isSessionOpen() && sim900Sent(modem, session, 5));
+  modem.clearOutput();
+  // the session is reused: no more commands
+  bench.check("sim900.openSession.reuse",
+    sim900.openSession("apn") == SIM900::Error::NONE
+    && modem.getOutput().empty());
+  bench.check("sim900.postBatch", sim900.postBatch("example.com", 80,
+    "/batch", batch, sizeof(batch)) == SIM900::Error::NONE
+    && sim900Sent(modem, post, 5) && sim900CipsendLength(modem)
+    && modem.getOutput().find(std::string((const char*)batch,
+      sizeof(batch))) != std::string::npos);
+  modem.clearOutput();
+  bench.check("sim900.sendBatch", sim900.sendBatch("example.com", 80,
+    batch, sizeof(batch)) == SIM900::Error::NONE
+    && sim900CipsendLength(modem));
+  modem.clearOutput();
+  sim900.closeSession();
+  bench.check("sim900.closeSession", !sim900.isSessionOpen()
+    && modem.getOutput().find("AT+CIPSHUT") != std::string::npos);
+  modem.clearOutput();
+  bench.check("sim900.postBatch.closed", sim900.postBatch("example.com",
+    80, "/batch", batch, sizeof(batch)) == SIM900::Error::NO_SESSION
+    && sim900.sendBatch("example.com", 9000, batch, sizeof(batch))
+    == SIM900::Error::NO_SESSION && modem.getOutput().empty());
+  // the connection fails: the session is closed
+  sim900.openSession("apn");
+  modem.clearReplies();
+  modem.reply("AT+CIPSTART", "\r\nOK\r\n\r\nCONNECT FAIL\r\n");
+  modem.reply("AT+CIPSHUT", "\r\nSHUT OK\r\n");
+  bench.check("sim900.postBatch.fail", sim900.postBatch("example.com",
+    80, "/batch", batch, sizeof(batch)) == SIM900::Error::TIMEOUT
+    && !sim900.isSessionOpen());
+  modem.clearReplies();
+  sim900Replies(modem);
+  sim900.openSession("apn");
+
+  bench.run("sim900.postBatch", 20000, [&]() {
+    modem.clearOutput();
+    benchSink += (uint8_t)sim900.postBatch("example.com", 80,
+      "/batch", batch, sizeof(batch));
+  });
+};
+
+static void benchDht(Bench &bench) {
+  Dht dht(DHT_PIN, Dht::TypeEL::DHT22);
+  Dht::Result result;
+  dhtSetup();
+  hostSetDigitalRead(dhtDigitalRead);
+  result = dht.read();
+  bench.check("dht.read", result.status == Dht::StatusEL::OK
+    && fabs(result.humidity - 55.3) < 0.01
+    && fabs(result.temperature + 10.1) < 0.01);
+  // the full read: the data request, the 40 bits decoding and the CRC
+  bench.run("dht.read", 20000, [&]() {
+    // end the 2 seconds reuse window
+    hostAdvanceTime(2001000UL);
+    benchSink += (uint8_t)dht.read().status;
+  });
+  // a read in the reuse window (the last value is returned)
+  bench.run("dht.read.cached", 1000000, [&]() {
+    benchSink += (uint8_t)dht.read().status;
+  });
+  // the cache: the first reading after the minimum interval, then get
+  // returns the cached value without reading the sensor
+  DhtCache cache(dht);
+  hostAdvanceTime(2001000UL);
+  bench.check("dht.cache.update", cache.update() && !cache.update());
+  bench.check("dht.cache.get", cache.get().fresh
+    && cache.get().status == Dht::StatusEL::OK);
+  bench.run("dht.cache.get", 1000000, [&]() {
+    benchSink += (uint8_t)cache.get().fresh;
+  });
+  // update from loop, when no reading is due
+  bench.run("dht.cache.update", 1000000, [&]() {
+    benchSink += (uint8_t)cache.update();
+  });
+  hostSetDigitalRead(0);
+};
+
+static void benchHcsr04(Bench &bench) {
+  HCSR04 hcsr04(TRIGGER_PIN, ECHO_PIN);
+  hostSetPulseIn(hcsr04PulseIn);
+  bench.check("hcsr04.readMm", hcsr04.readMm() == 200);
+  bench.run("hcsr04.readMm", 1000000, [&]() {
+    benchSink += hcsr04.readMm();
+  });
+  bench.run("hcsr04.readInt.cm", 1000000, [&]() {
+    benchSink += hcsr04.readInt<HCSR04::MetricsEL::cm>();
+  });
+  bench.run("hcsr04.read.float.cm", 1000000, [&]() {
+    benchSink += (uint32_t)hcsr04.read(HCSR04::MetricsEL::cm);
+  });
+  // setMaxRange is limited to HCSR04_MAX_RANGE (40m, about 233ms echo),
+  // the echo keeps all its bits and the 16.16 mm conversion does not overflow
+  hostSetPulseIn(hcsr04MaxRangePulseIn);
+  hcsr04.setMaxRange(0xFFFF);
+  unsigned long echo = hcsr04.readEcho();
+  unsigned int mm = hcsr04.readMm();
+  bench.check("hcsr04.setMaxRange.clamp", sizeof(echo) == sizeof(hcsr04.readEcho())
+    && echo == (unsigned long)HCSR04_MAX_RANGE * 582 / 10
+    && mm > HCSR04_MAX_RANGE * 10 - 100 && mm < HCSR04_MAX_RANGE * 10 + 100);
+  hostSetPulseIn(0);
+  // the echo pin interrupt (INT0, pin 2) is detached by the destructor,
+  // and the interrupt is free for another instance
+  bool attached = false;
+  {
+    HCSR04 async(TRIGGER_PIN, 2);
+    attached = async.trigger() && hostInterruptRoutine(0) != 0;
+  }
+  bench.check("hcsr04.detach", attached && hostInterruptRoutine(0) == 0);
+  HCSR04 next(TRIGGER_PIN, 2);
+  bench.check("hcsr04.attach", next.trigger() && hostInterruptRoutine(0) != 0);
+};
+
+/**
+ * Accuracy of the integer conversions: every 10 bits ADC value is
+ * converted and compared with the floating point formula.
+ * Tolerance: LM35 - less than 1 centi-degree (the result is truncated);
+ * VT93N1 - 2.5 lux below 250 lux, 1% above (the interpolation error).
+ */
+static void checkConversions(Bench &bench) {
+  double lm35Error = 0, vt93n1Error = 0, vt93n1RelError = 0;
+  for (uint16_t adc = 0; adc < 1024; adc++) {
+    double expected = adc * (LM35_VREF / 1024.0) * 10;
+    if (expected > LM35_MAX_CENTI_CELSIUS) expected = LM35_MAX_CENTI_CELSIUS;
+    double error = fabs(LM35::toCentiCelsius(adc) - expected);
+    if (error > lm35Error) lm35Error = error;
+
+    expected = 0;
+    if (adc > 0) {
+      double r1 = VT93N1_R2 * (VT93N1_VIN * 1024 / (VT93N1_VREF * adc) - 1);
+      expected = 341.64 / pow(r1 / 1000.0, 10.0 / 9.0);
+      if (expected > VT93N1_MAX_LUX) expected = VT93N1_MAX_LUX;
+    }
+    error = fabs(VT93N1::toLux(adc) - expected);
+    if (expected < 250) {
+      if (error > vt93n1Error) vt93n1Error = error;
+    } else if (error / expected > vt93n1RelError) {
+      vt93n1RelError = error / expected;
+    }
+  }
+  printf("%-32s max error %.2f centi-degrees\n", "lm35.accuracy", lm35Error);
+  printf("%-32s max error %.2f lux (< 250 lux), %.2f%% (>= 250 lux)\n",
+    "vt93n1.accuracy", vt93n1Error, vt93n1RelError * 100);
+  bench.check("lm35.accuracy", lm35Error < 1);
+  bench.check("vt93n1.accuracy", vt93n1Error <= 2.5 && vt93n1RelError <= 0.01);
+  // less than 10 bits: the value is scaled to 10 bits
+  bool scaled = true;
+  for (uint16_t adc = 0; adc < 256; adc++)
+    scaled = scaled && VT93N1::toLux(adc, 8) == VT93N1::toLux(adc << 2);
+  bench.check("vt93n1.resolution", scaled);
+};
+
+/**
+ * SampleEncoder/SampleDecoder round trip: all the channels, negative
+ * deltas, status samples and a millis() rollover between two samples.
+ * Then the truncated and the corrupt batches must be rejected.
+ */
+static const uint8_t CODEC_SAMPLES = 24;
+static Sensor::Sample codecSamples[CODEC_SAMPLES];
+
+static void codecSetup() {
+  // starts 300ms before the millis() rollover
+  uint32_t timestamp = 0xFFFFFFFFUL - 300;
+  for (uint8_t i = 0; i < CODEC_SAMPLES; i++) {
+    Sensor::Sample &sample = codecSamples[i];
+    sample.channel = i % SAMPLE_CODEC_MAX_CHANNELS;
+    sample.timestamp = timestamp;
+    // small and large, positive and negative changes
+    sample.value = (i & 1 ? -1 : 1) * (int32_t)i * (i < 16 ? 7 : 100003);
+    sample.status = i % 5 == 4 ? Sensor::StatusEL::TIMEOUT
+      : i % 7 == 6 ? Sensor::StatusEL::ERROR : Sensor::StatusEL::OK;
+    timestamp += i < 8 ? 50 : 70000UL;
+  }
+};
+
+// decode a batch, and check the samples with the encoded ones
+static uint8_t codecDecode(const uint8_t *data, uint16_t length, bool &same) {
+  SampleDecoder decoder(data, length);
+  Sensor::Sample sample;
+  uint8_t count = 0;
+  same = true;
+  while (decoder.next(sample)) {
+    if (count >= CODEC_SAMPLES) {
+      same = false;
+      break;
+    }
+    const Sensor::Sample &expected = codecSamples[count];
+    if (sample.channel != expected.channel
+      || sample.timestamp != expected.timestamp
+      || sample.status != expected.status
+      || (sample.status == Sensor::StatusEL::OK
+        && sample.value != expected.value)) {
+      same = false;
+      break;
+    }
+    count++;
+  }
+  return count;
+};
+
+static void benchSampleCodec(Bench &bench) {
+  uint8_t buffer[256], corrupt[256];
+  SampleEncoder encoder(buffer, sizeof(buffer));
+  bool same = true, ok = true;
+  uint16_t length = 0, count = 0;
+  codecSetup();
+  encoder.begin(codecSamples[0].timestamp);
+  for (uint8_t i = 0; i < CODEC_SAMPLES; i++) {
+    ok = ok && encoder.add(codecSamples[i]);
+  }
+  length = encoder.getLength();
+  bench.check("sampleCodec.encode", ok && encoder.getCount() == CODEC_SAMPLES);
+  bench.check("sampleCodec.roundTrip",
+    codecDecode(buffer, length, same) == CODEC_SAMPLES && same);
+  // every truncation gives only complete, correct samples
+  ok = true;
+  for (uint16_t i = 0; i < length; i++) {
+    count = codecDecode(buffer, i, same);
+    ok = ok && same && count < CODEC_SAMPLES;
+  }
+  bench.check("sampleCodec.truncated", ok);
+  // a full buffer: the sample is not added and the batch is unchanged
+  SampleEncoder small(corrupt, length - 1);
+  small.begin(codecSamples[0].timestamp);
+  for (uint8_t i = 0; i < CODEC_SAMPLES; i++) small.add(codecSamples[i]);
+  bench.check("sampleCodec.full", small.getCount() < CODEC_SAMPLES
+    && codecDecode(corrupt, small.getLength(), same) == small.getCount()
+    && same);
+  // wrong version, unknown channel and too long varint
+  memcpy(corrupt, buffer, length);
+  corrupt[0] = SAMPLE_CODEC_VERSION + 1;
+  ok = !SampleDecoder(corrupt, length).isValid()
+    && codecDecode(corrupt, length, same) == 0;
+  const uint8_t channel[] = {SAMPLE_CODEC_VERSION, 0x00,
+    SAMPLE_CODEC_MAX_CHANNELS, 0x01, 0x02};
+  SampleDecoder channelDecoder(channel, sizeof(channel));
+  Sensor::Sample sample;
+  ok = ok && !channelDecoder.next(sample) && !channelDecoder.isValid();
+  const uint8_t varint[] = {SAMPLE_CODEC_VERSION, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x02};
+  SampleDecoder varintDecoder(varint, sizeof(varint));
+  ok = ok && !varintDecoder.next(sample) && !varintDecoder.isValid();
+  bench.check("sampleCodec.corrupt", ok);
+  // the largest value swings (the deltas overflow int32), and a status
+  // sample is 3 bytes: channel byte, timestamp delta and status
+  const int32_t swings[] = {INT32_MAX, INT32_MIN, INT32_MAX, -1, INT32_MIN};
+  SampleEncoder swing(corrupt, sizeof(corrupt));
+  swing.begin(0);
+  sample.channel = 3;
+  sample.timestamp = 0;
+  sample.status = Sensor::StatusEL::OK;
+  for (uint8_t i = 0; i < sizeof(swings) / sizeof(swings[0]); i++) {
+    sample.value = swings[i];
+    swing.add(sample);
+  }
+  length = swing.getLength();
+  sample.status = Sensor::StatusEL::TIMEOUT;
+  swing.add(sample);
+  ok = swing.getLength() == length + 3
+    && corrupt[length] == (3 | SAMPLE_CODEC_STATUS_FLAG);
+  SampleDecoder swingDecoder(corrupt, swing.getLength());
+  for (uint8_t i = 0; i < sizeof(swings) / sizeof(swings[0]); i++)
+    ok = ok && swingDecoder.next(sample) && sample.value == swings[i];
+  ok = ok && swingDecoder.next(sample)
+    && sample.status == Sensor::StatusEL::TIMEOUT && !swingDecoder.next(sample);
+  bench.check("sampleCodec.swing", ok);
+  length = encoder.getLength();
+  printf("%-32s %u samples in %u bytes\n", "sampleCodec.size",
+    CODEC_SAMPLES, length);
+
+  bench.run("sampleCodec.encode", 100000, [&]() {
+    encoder.begin(codecSamples[0].timestamp);
+    for (uint8_t i = 0; i < CODEC_SAMPLES; i++) encoder.add(codecSamples[i]);
+    benchSink += encoder.getLength();
+  });
+  bench.run("sampleCodec.decode", 100000, [&]() {
+    SampleDecoder decoder(buffer, length);
+    while (decoder.next(sample)) benchSink += sample.value;
+  });
+};
+
+static void benchAggregator(Bench &bench) {
+  Aggregator aggregator(AGGREGATOR_DEFAULT_HEARTBEAT);
+  Aggregator::Record record;
+  Sensor::Sample sample;
+  bool ok = true;
+  sample.channel = 2;
+  sample.status = Sensor::StatusEL::OK;
+  aggregator.setDeadband(2, 10);
+  // the deltas overflow int32: INT32_MIN - INT32_MAX is not a small change
+  sample.value = INT32_MAX;
+  ok = aggregator.add(sample, record) && record.reason == Aggregator::ReasonEL::FIRST;
+  sample.value = INT32_MIN;
+  ok = ok && aggregator.add(sample, record)
+    && record.reason == Aggregator::ReasonEL::DEADBAND;
+  bench.check("aggregator.deadband", ok);
+  // the window sum overflows: the full window is reported, then the
+  // sample beyond the deadband is reported by the next call
+  sample.value = INT32_MIN + 5;
+  ok = !aggregator.add(sample, record);
+  sample.value = -(1L << 30);
+  ok = ok && aggregator.add(sample, record)
+    && record.reason == Aggregator::ReasonEL::WINDOW_FULL
+    && record.value == INT32_MIN + 5 && record.count == 1;
+  ok = ok && aggregator.add(sample, record)
+    && record.reason == Aggregator::ReasonEL::DEADBAND
+    && record.value == -(1L << 30) && record.count == 2;
+  ok = ok && !aggregator.add(sample, record);
+  bench.check("aggregator.windowFull", ok);
+};
+
+static void benchConversions(Bench &bench) {
+  uint16_t adc = 0;
+  checkConversions(bench);
+  // LM35, 12 bits (oversampled) values: integer vs. float
+  bench.check("lm35.toCentiCelsius", LM35::toCentiCelsius(176, 12) == 2148);
+  bench.run("lm35.toCentiCelsius", 1000000, [&]() {
+    benchSink += LM35::toCentiCelsius(adc++ & 0x0FFF, 12);
+  });
+  bench.run("lm35.float", 1000000, [&]() {
+    float temperature = (adc++ & 0x0FFF) * 0.00122 * 100;
+    benchSink += (uint32_t)(temperature * 100);
+  });
+  // VT93N1, 10 bits values: lookup table vs. float formula
+  bench.run("vt93n1.toLux", 1000000, [&]() {
+    benchSink += VT93N1::toLux(adc++ & 0x03FF);
+  });
+  bench.run("vt93n1.float", 1000000, [&]() {
+    double vAcrossR2 = ((adc++ & 0x03FF) | 1) * 0.00488;
+    double r1 = 10000 * (5 / vAcrossR2 - 1);
+    benchSink += (uint32_t)(341.64 / pow(r1 / 1000.0, 10.0 / 9.0));
+  });
+};
+
+/**
+ * Write the results as JSON:
+ * {"commit": "...", "results": [{"name": "...", "iterations": n,
+ *  "best_ns": x, "median_ns": y}, ...]}
+ */
+bool Bench::write(const char *path, const char *commit) {
+  FILE *file = fopen(path, "w");
+  if (!file) return false;
+  fprintf(file, "{\"commit\": \"%s\", \"results\": [", commit);
+  for (size_t i = 0; i < this->results.size(); i++) {
+    const Result &result = this->results[i];
+    fprintf(file, "%s\n  {\"name\": \"%s\", \"iterations\": %u, "
+      "\"best_ns\": %.2f, \"median_ns\": %.2f}", i ? "," : "",
+      result.name.c_str(), result.iterations,
+      result.bestNs, result.medianNs);
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+};
+
+int main(int argc, char **argv) {
+  const char *output = 0, *commit = "";
+  Bench bench;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "-o") == 0) output = argv[i + 1];
+    else if (strcmp(argv[i], "-c") == 0) commit = argv[i + 1];
+  }
+  benchUtil(bench);
+  benchEsp8266(bench);
+  benchEsp8266Mqtt(bench);
+  benchEsp8266Link(bench);
+  benchUartStream(bench);
+  benchEsp8266Server(bench);
+  benchSim900(bench);
+  benchDht(bench);
+  benchHcsr04(bench);
+  benchConversions(bench);
+  benchSampleCodec(bench);
+  benchAggregator(bench);
+  if (output && !bench.write(output, commit)) {
+    printf("cannot write %s\n", output);
+    return 2;
+  }
+  return bench.getFailed() ? 1 : 0;
+};
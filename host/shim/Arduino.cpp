@@ -0,0 +1,256 @@
+#include <Arduino.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+static unsigned long now = 0;
+static unsigned long pinModeTime[NUM_DIGITAL_PINS] = {0};
+static uint8_t pinValue[NUM_DIGITAL_PINS] = {0};
+static int (*digitalReadHook)(uint8_t pin) = 0;
+static int (*analogReadHook)(uint8_t pin) = 0;
+static unsigned long (*pulseInHook)(uint8_t pin, uint8_t state,
+  unsigned long timeout) = 0;
+// the external interrupts INT0 and INT1
+static void (*interruptRoutines[2])(void) = {0, 0};
+
+unsigned long millis() {
+  now += HOST_TICK_US;
+  return now / 1000;
+};
+
+unsigned long micros() {
+  now += HOST_TICK_US;
+  return now;
+};
+
+void delay(unsigned long ms) {
+  now += ms * 1000;
+};
+
+void delayMicroseconds(unsigned int us) {
+  now += us;
+};
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)mode;
+  if (pin < NUM_DIGITAL_PINS) pinModeTime[pin] = now;
+};
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < NUM_DIGITAL_PINS) pinValue[pin] = value;
+};
+
+/**
+ * Read a pin: the value returned by the hook (see hostSetDigitalRead),
+ * or the last written value if no hook is set.
+ */
+int digitalRead(uint8_t pin) {
+  now += HOST_TICK_US;
+  if (digitalReadHook) return digitalReadHook(pin);
+  return pin < NUM_DIGITAL_PINS ? pinValue[pin] : LOW;
+};
+
+int analogRead(uint8_t pin) {
+  return analogReadHook ? analogReadHook(pin) : 0;
+};
+
+/**
+ * Measure a pulse: the duration returned by the hook (see hostSetPulseIn),
+ * or 0 (no pulse) if no hook is set. The virtual time advances with the
+ * pulse duration, or with the timeout if there is no pulse.
+ */
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+  unsigned long duration = 0;
+  if (pulseInHook) duration = pulseInHook(pin, state, timeout);
+  if (duration > timeout) duration = 0;
+  now += duration ? duration : timeout;
+  return duration;
+};
+
+void attachInterrupt(uint8_t interruptNr, void (*isr)(void), int mode) {
+  (void)mode;
+  if (interruptNr < 2) interruptRoutines[interruptNr] = isr;
+};
+
+void detachInterrupt(uint8_t interruptNr) {
+  if (interruptNr < 2) interruptRoutines[interruptNr] = 0;
+};
+
+void (*hostInterruptRoutine(uint8_t interruptNr))(void) {
+  return interruptNr < 2 ? interruptRoutines[interruptNr] : 0;
+};
+
+void noInterrupts() {};
+
+void interrupts() {};
+
+long random(long max) {
+  return max > 0 ? rand() % max : 0;
+};
+
+long random(long min, long max) {
+  return min < max ? min + random(max - min) : min;
+};
+
+/**
+ * Set the virtual time (in microseconds).
+ */
+void hostSetTime(unsigned long us) {
+  now = us;
+};
+
+/**
+ * Advance the virtual time (e.g., to end a sensor reuse window).
+ */
+void hostAdvanceTime(unsigned long us) {
+  now += us;
+};
+
+/**
+ * Get the virtual time (in microseconds), without advancing it.
+ */
+unsigned long hostTime() {
+  return now;
+};
+
+/**
+ * Get the virtual time of the last pinMode call for a pin,
+ * e.g., to simulate a sensor answering to a request.
+ */
+unsigned long hostPinModeTime(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? pinModeTime[pin] : 0;
+};
+
+void hostSetDigitalRead(int (*hook)(uint8_t pin)) {
+  digitalReadHook = hook;
+};
+
+void hostSetPulseIn(unsigned long (*hook)(uint8_t pin, uint8_t state,
+  unsigned long timeout)) {
+  pulseInHook = hook;
+};
+
+void hostSetAnalogRead(int (*hook)(uint8_t pin)) {
+  analogReadHook = hook;
+};
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += this->write(*buffer++);
+  return n;
+};
+
+size_t Print::print(long value, int base) {
+  if (value < 0 && base == DEC) {
+    size_t n = this->print('-');
+    return n + this->print(0UL - (unsigned long)value, base);
+  }
+  return this->print((unsigned long)value, base);
+};
+
+size_t Print::print(unsigned long value, int base) {
+  char buffer[8 * sizeof(long) + 1];
+  char *p = &buffer[sizeof(buffer) - 1];
+  if (base < 2) base = DEC;
+  *p = '\0';
+  do {
+    char digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  return this->write(p);
+};
+
+size_t Print::print(double value, int digits) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return this->write(buffer);
+};
+
+/**
+ * Read a byte, waiting at most the stream timeout for it (as Arduino).
+ */
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    if (this->available()) return this->read();
+  } while (millis() - start < this->timeout);
+  return -1;
+};
+
+/**
+ * Read data until the target is found (true) or the timeout
+ * occurs (false), as Arduino.
+ */
+bool Stream::find(const char *target) {
+  size_t length = strlen(target), index = 0;
+  int c = 0;
+  if (length == 0) return true;
+  while ((c = this->timedRead()) >= 0) {
+    if (c == target[index]) {
+      if (++index >= length) return true;
+    } else index = (c == target[0]) ? 1 : 0;
+  }
+  return false;
+};
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t n = 0;
+  int c = 0;
+  while (n < length && (c = this->timedRead()) >= 0) buffer[n++] = c;
+  return n;
+};
+
+/**
+ * Capture a written byte, and queue the modem response
+ * when a line with a registered command is written.
+ */
+size_t HostStream::write(uint8_t c) {
+  this->output += (char)c;
+  if (this->dataRemaining < 0) {
+    if (c == 0x1A) this->endData();
+    else this->data += (char)c;
+  } else if (this->dataRemaining > 0) {
+    this->data += (char)c;
+    if (--this->dataRemaining == 0) this->endData();
+  } else if (c == '\n') {
+    this->command();
+    this->line.clear();
+  } else this->line += (char)c;
+  return 1;
+};
+
+/**
+ * Reply to the command line, and start the data mode for AT+CIPSEND.
+ */
+void HostStream::command() {
+  for (size_t i = 0; i < this->replies.size(); i++)
+    if (this->line.compare(0, this->replies[i].command.size(),
+      this->replies[i].command) == 0) {
+      this->input.append(this->replies[i].response);
+      break;
+    }
+  if (this->line.compare(0, 10, "AT+CIPSEND") != 0) return;
+  // AT+CIPSEND=[linkId,]length, or AT+CIPSEND (data up to Ctrl+Z)
+  size_t separator = this->line.find_last_of("=,");
+  this->dataRemaining = separator == std::string::npos ? -1
+    : atol(this->line.c_str() + separator + 1);
+  this->data.clear();
+};
+
+/**
+ * End of the AT+CIPSEND data: give it to the data handler.
+ */
+void HostStream::endData() {
+  this->dataRemaining = 0;
+  if (this->dataHandler) this->dataHandler(*this, this->data);
+  this->data.clear();
+};
+
+int HostStream::read() {
+  if (!this->available()) return -1;
+  int c = (uint8_t)this->input[this->position++];
+  // all the queued data was read, reuse the buffer
+  if (this->position == this->input.size()) this->clearInput();
+  return c;
+};
@@ -0,0 +1,138 @@
+/*
+ * Minimal Arduino core for the host (Linux) build of the libraries.
+ *
+ * Only what the libraries use is provided. The time is virtual: it
+ * starts at 0 and advances by HOST_TICK_US on every millis, micros and
+ * digitalRead call (so the busy-wait loops end), and by the requested
+ * time on delay and delayMicroseconds. The pins are simulated with
+ * hooks (see hostSetDigitalRead and hostSetPulseIn).
+ *
+ * @file Arduino.h
+ * @version 1.0
+ */
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+// virtual time advance (in microseconds) for every time or pin read
+#define HOST_TICK_US 1
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define NUM_DIGITAL_PINS 20
+#define DEC 10
+#define HEX 16
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+#define F(string) (string)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+unsigned long pulseIn(uint8_t pin, uint8_t state,
+  unsigned long timeout = 1000000UL);
+void attachInterrupt(uint8_t interruptNr, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interruptNr);
+void noInterrupts();
+void interrupts();
+long random(long max);
+long random(long min, long max);
+
+// host only: the simulation hooks
+void hostSetTime(unsigned long us);
+void hostAdvanceTime(unsigned long us);
+unsigned long hostTime();
+unsigned long hostPinModeTime(uint8_t pin);
+void hostSetDigitalRead(int (*hook)(uint8_t pin));
+void hostSetPulseIn(unsigned long (*hook)(uint8_t pin, uint8_t state,
+  unsigned long timeout));
+void hostSetAnalogRead(int (*hook)(uint8_t pin));
+// the routine attached to an external interrupt (0 if none)
+void (*hostInterruptRoutine(uint8_t interruptNr))(void);
+
+class Print {
+  public:
+    virtual ~Print() {};
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) {
+      return str ? this->write((const uint8_t*)str, strlen(str)) : 0;
+    };
+    size_t print(const char str[]) { return this->write(str); };
+    size_t print(char c) { return this->write((uint8_t)c); };
+    size_t print(unsigned char value, int base = DEC) {
+      return this->print((unsigned long)value, base);
+    };
+    size_t print(int value, int base = DEC) {
+      return this->print((long)value, base);
+    };
+    size_t print(unsigned int value, int base = DEC) {
+      return this->print((unsigned long)value, base);
+    };
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t println() { return this->write("\r\n"); };
+    template <class T> size_t println(T value) {
+      size_t n = this->print(value);
+      return n + this->println();
+    };
+    template <class T> size_t println(T value, int format) {
+      size_t n = this->print(value, format);
+      return n + this->println();
+    };
+};
+
+class Stream: public Print {
+  public:
+    Stream(): timeout(1000) {};
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {};
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; };
+    bool find(const char *target);
+    bool find(char *target) { return this->find((const char*)target); };
+    size_t readBytes(char *buffer, size_t length);
+  protected:
+    unsigned long timeout;
+    int timedRead();
+};
+
+#include "HostStream.h"
+
+// the hardware serial port, as an emulated modem (see HostStream)
+class HardwareSerial: public HostStream {
+  public:
+    void begin(unsigned long baud) { (void)baud; };
+    void end() {};
+};
+extern HardwareSerial Serial;
+#endif
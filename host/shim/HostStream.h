@@ -0,0 +1,74 @@
+/*
+ * In-memory Stream for the host build: the data "received" by the
+ * MCU is queued with feed, the data written by the MCU is captured.
+ * It is also a minimal AT modem emulator: for every written line
+ * (ended by '\n') starting with a registered command, the command
+ * response is queued as received data. The data sent after an
+ * AT+CIPSEND command (the announced length, or up to Ctrl+Z if no
+ * length is given, as SIM900) is not parsed as commands: it is given
+ * to the data handler, if any, e.g., a server stand-in which feeds
+ * its (binary) answer after the data.
+ *
+ * @file HostStream.h
+ * @version 1.0
+ */
+#ifndef __HOST_STREAM_H__
+#define __HOST_STREAM_H__
+
+#include <string>
+#include <vector>
+
+class HostStream: public Stream {
+  public:
+    using Print::write;
+    HostStream(): position(0), dataRemaining(0), dataHandler(0) {};
+    void feed(const char *data) { this->input.append(data); };
+    void feed(const uint8_t *data, size_t length) {
+      this->input.append((const char*)data, length);
+    };
+    void reply(const char *command, const char *response) {
+      this->replies.push_back(Reply{command, response});
+    };
+    // binary response, which may contain \0 bytes
+    void reply(const char *command, const uint8_t *response, size_t length) {
+      this->replies.push_back(
+        Reply{command, std::string((const char*)response, length)});
+    };
+    typedef void (*DataHandler)(HostStream &stream, const std::string &data);
+    // called with the AT+CIPSEND data, after all of it was written
+    void setDataHandler(DataHandler handler) { this->dataHandler = handler; };
+    void clearReplies() { this->replies.clear(); };
+    // the data written by the MCU, since the last clearOutput call
+    const std::string& getOutput() const { return this->output; };
+    void clearOutput() { this->output.clear(); };
+    void clearInput() {
+      this->input.clear();
+      this->position = 0;
+    };
+    size_t write(uint8_t c) override;
+    int available() override {
+      return this->input.size() - this->position;
+    };
+    int read() override;
+    int peek() override {
+      return this->available() ? (uint8_t)this->input[this->position] : -1;
+    };
+  private:
+    struct Reply {
+      std::string command;
+      std::string response;
+    };
+    std::string input;
+    size_t position;
+    std::string output;
+    std::string line;
+    std::vector<Reply> replies;
+    // bytes of AT+CIPSEND data still to be written (-1: up to Ctrl+Z)
+    long dataRemaining;
+    // the AT+CIPSEND data written so far
+    std::string data;
+    DataHandler dataHandler;
+    void command();
+    void endData();
+};
+#endif
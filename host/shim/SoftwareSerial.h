@@ -0,0 +1,18 @@
+/*
+ * Host build: a software serial port is an emulated modem (see HostStream).
+ */
+#ifndef __HOST_SOFTWARE_SERIAL_H__
+#define __HOST_SOFTWARE_SERIAL_H__
+
+#include <Arduino.h>
+
+class SoftwareSerial: public HostStream {
+  public:
+    SoftwareSerial(uint8_t rxPin, uint8_t txPin) {
+      (void)rxPin; (void)txPin;
+    };
+    void begin(long baud) { (void)baud; };
+    void end() {};
+    bool listen() { return true; };
+};
+#endif
@@ -0,0 +1,10 @@
+/*
+ * Host build: interrupts are not simulated.
+ */
+#ifndef __HOST_INTERRUPT_H__
+#define __HOST_INTERRUPT_H__
+
+#define ISR(vector) extern "C" void vector(void)
+#define cli()
+#define sei()
+#endif
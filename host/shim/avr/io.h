@@ -0,0 +1,26 @@
+/*
+ * Host build: no MCU registers (the register based code, e.g.,
+ * AnalogSampler, is not part of the host build). Only the USART0
+ * register bits (ATmega328P values) are defined, so UartStream can
+ * be used with in-memory registers (see the benchmarks).
+ */
+#ifndef __HOST_IO_H__
+#define __HOST_IO_H__
+
+#define _BV(bit) (1 << (bit))
+// UCSR0A
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define U2X0 1
+#define MPCM0 0
+// UCSR0B
+#define RXCIE0 7
+#define RXEN0 4
+#define TXEN0 3
+// UCSR0C
+#define UCSZ01 2
+#define UCSZ00 1
+#endif
@@ -0,0 +1,10 @@
+/*
+ * Host build: no interrupts, so the atomic blocks run only once.
+ */
+#ifndef __HOST_ATOMIC_H__
+#define __HOST_ATOMIC_H__
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int __done = 0; !__done; __done = 1)
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Common UART transport for the AT command based modules
+ * (e.g., ESP8266 WiFi, SIM900 GSM/GPRS).
+ *
+ * @file ATTransport.h
+ * @version 1.0
+ */ 
+#ifndef __AT_TRANSPORT_H__
+#define __AT_TRANSPORT_H__
+
+#include "Util.h"
+// the Trace library is optional: without it, the TRACE calls are removed
+#if defined(__has_include)
+#if __has_include(<Trace.h>)
+#include <Trace.h>
+#endif
+#endif
+#ifndef TRACE
+#define TRACE(id, arg) ((void)0)
+#endif
+#include <Arduino.h>
+
+// size of the buffer used to load PROGMEM commands and responses
+// (the longest one, 33 chars, plus the '\0')
+#define AT_CMD_BUFFER_SIZE 34
+
+// The errors reported by all the AT modules (not a template, 
+// so the error type is the same for all the transports).
+class ATTransportBase {
+  public:
+    enum class Error {
+      NONE = 0,
+      TIMEOUT = 1,
+      EMPTY_DATA,
+      EMPTY_STREAM,
+      // less data than announced was received (e.g., RX buffer overflow)
+      DATA_LOST,
+      // no open session (e.g., SIM900 GPRS, see SIM900::openSession)
+      NO_SESSION
+    };
+};
+
+/**
+ * The transport is any class providing the Stream methods (print, write,
+ * available, read and find), e.g., HardwareSerial, SoftwareSerial or a
+ * host mock. With a final class (e.g., UartStream), the calls are
+ * resolved at compile time and can be inlined; with a non final class
+ * (e.g., HardwareSerial) they are still virtual calls.
+ */
+template <class Transport>
+class ATTransportT: public ATTransportBase {
+  public:
+    ATTransportT(Transport& ser): serial(ser) {
+      this->cmdData = this->cmdBuffer;
+      this->cmdLen = 0;
+      this->cTime = 0;
+    };
+    void clearSerialBuffer();
+    /**
+     * Get the number of received bytes not read yet (e.g., a +IPD frame).
+     */
+    int available() { return this->serial.available(); };
+
+  protected:
+    char cmdBuffer[AT_CMD_BUFFER_SIZE];
+    char *cmdData;
+    uint8_t cmdLen;
+    uint32_t cTime;
+    Transport& serial;
+    void sendPM(const char pmData[]);
+    Error checkTimeout(const char* response, uint16_t timeout);
+    inline Error checkTimeout(const char response, uint16_t timeout) {
+      const char data[2] = {response, '\0'};
+      return this->checkTimeout(data, timeout);
+    };
+    Error checkTimeoutPM(const char pmResponse[], uint16_t timeout);
+    /**
+     * Get the remaining time of a command timeout, 
+     * measured from the last startTimer call.
+     */
+    inline long remainingTime(uint16_t timeout) {
+      return timeout - (long)(millis() - this->cTime);
+    };
+    inline void startTimer() {
+      this->cTime = millis();
+    };
+};
+// the transport used by default: any Stream (e.g., Serial)
+typedef ATTransportT<Stream> ATTransport;
+
+/************************************************************************/
+/* @method                                                              */
+/* Utility method used to clear serial buffer                           */
+/************************************************************************/
+template <class Transport>
+void ATTransportT<Transport>::clearSerialBuffer() {
+  while (this->serial.available())
+    this->serial.read();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Utility method used to send a PROGMEM string (e.g., a command)       */
+/* @param pmData                                                        */
+/*          the PROGMEM string                                          */
+/************************************************************************/
+template <class Transport>
+void ATTransportT<Transport>::sendPM(const char pmData[]) {
+  getPMData(pmData, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Utility method used to detect command responde timeout               */
+/* @param response                                                      */
+/*         the responde to wait for                                     */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for response before gave up)                                */
+/* @return Error::NONE if all OK, Error::XXX otherwise                  */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ATTransportT<Transport>::checkTimeout(
+  const char* response, uint16_t timeout) {
+  
+  // start recording elapsed time
+  uint32_t start = millis();
+  TRACE(TRACE_EV_AT_WAIT_START, timeout);
+  // wait for response
+  while((millis() - start) < timeout) 
+    if (this->serial.available() >= 1 && this->serial.find((char*)response)) {
+      TRACE(TRACE_EV_AT_WAIT_END, 0);
+      return Error::NONE;
+    }
+  // timeout error...
+  TRACE(TRACE_EV_AT_WAIT_END, 1);
+  return Error::TIMEOUT;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Utility method used to detect command responde timeout, for a        */
+/* response stored in PROGMEM                                           */
+/* @param pmResponse                                                    */
+/*         the PROGMEM responde to wait for                             */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for response before gave up)                                */
+/* @return Error::NONE if all OK, Error::XXX otherwise                  */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ATTransportT<Transport>::checkTimeoutPM(
+  const char pmResponse[], uint16_t timeout) {
+  getPMData(pmResponse, this->cmdData, this->cmdLen);
+  return this->checkTimeout(this->cmdData, timeout);
+};
+
+// constants stored in RAM
+const char AT_CMD_END[] = "\r\n";
+const char AT_OK[] = "OK\r\n";
+const char AT_EQUAL = '=';
+const char AT_COMA = ',';
+const char AT_DQUOTE = '"';
+const char AT_GREATER_THAN = '>';
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Interrupt driven UART stream with a configurable size RX buffer
+ * and receive error counters (e.g., for the ESP8266 +IPD data).
+ *
+ * @file UartStream.h
+ * @version 1.0
+ */ 
+#ifndef __UART_STREAM_H__
+#define __UART_STREAM_H__
+
+#include <Arduino.h>
+#include <util/atomic.h>
+
+// default RX buffer size: the core HardwareSerial uses only 64 bytes
+#define UART_STREAM_DEFAULT_RX_BUFFER_SIZE 256
+
+// The registers of the USART ports, used as constructor parameters, 
+// e.g., UartStream<> espSerial(UART_STREAM_USART1);
+#if defined(UBRR0H)
+#define UART_STREAM_USART0 &UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0
+#endif
+#if defined(UBRR1H)
+#define UART_STREAM_USART1 &UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1
+#endif
+#if defined(UBRR2H)
+#define UART_STREAM_USART2 &UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2
+#endif
+#if defined(UBRR3H)
+#define UART_STREAM_USART3 &UBRR3H, &UBRR3L, &UCSR3A, &UCSR3B, &UCSR3C, &UDR3
+#endif
+
+/**
+ * Define the RX complete interrupt routine of the stream USART. 
+ * Use it ONCE, in the sketch file, e.g. (Arduino MEGA2560):
+ *   UartStream<> espSerial(UART_STREAM_USART1);
+ *   UART_STREAM_ISR(espSerial, USART1_RX_vect)
+ * NOTE: the port must not be used by the core HardwareSerial too
+ *       (e.g., don't use Serial1 in the sketch), otherwise the 
+ *       interrupt routine is defined twice. For the ATmega328P
+ *       (Arduino UNO), the USART0 vector is USART_RX_vect.
+ */
+#define UART_STREAM_ISR(stream, vector) \
+  ISR(vector) { stream.rxInterrupt(); }
+
+/**
+ * The class and its Stream methods are final, so the calls made via a
+ * UartStream typed transport (e.g., ESP8266T<UartStream<>>) are not
+ * virtual: they are resolved at compile time, and can be inlined.
+ */
+template <uint16_t Size = UART_STREAM_DEFAULT_RX_BUFFER_SIZE>
+class UartStream final: public Stream {
+  public:
+    /**
+     * Constructor (use the UART_STREAM_USARTx macros for parameters).
+     */
+    UartStream(volatile uint8_t *ubrrh, volatile uint8_t *ubrrl, 
+      volatile uint8_t *ucsra, volatile uint8_t *ucsrb, 
+      volatile uint8_t *ucsrc, volatile uint8_t *udr): ubrrh(ubrrh), 
+      ubrrl(ubrrl), ucsra(ucsra), ucsrb(ucsrb), ucsrc(ucsrc), udr(udr) {
+      this->head = 0;
+      this->tail = 0;
+      this->overruns = 0;
+      this->dataOverruns = 0;
+      this->frameErrors = 0;
+      this->highWaterMark = 0;
+      this->written = false;
+    };
+    /**
+     * Start the USART (8 data bits, no parity, 1 stop bit).
+     * @param baud
+     *          the baud rate, e.g., 115200
+     */
+    void begin(unsigned long baud) {
+      // double speed mode, as the core HardwareSerial does
+      uint16_t setting = (F_CPU / 4 / baud - 1) / 2;
+      *this->ucsra = _BV(U2X0);
+      *this->ubrrh = setting >> 8;
+      *this->ubrrl = setting;
+      *this->ucsrc = _BV(UCSZ01) | _BV(UCSZ00);
+      *this->ucsrb = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0);
+    };
+    void end() {
+      this->flush();
+      *this->ucsrb &= ~(_BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0));
+    };
+    int available() final {
+      uint16_t head = 0;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        head = this->head;
+      }
+      return (Size + head - this->tail) % Size;
+    };
+    int peek() final {
+      if (this->available() == 0) return -1;
+      return this->buffer[this->tail];
+    };
+    int read() final {
+      uint8_t c = 0;
+      if (this->available() == 0) return -1;
+      c = this->buffer[this->tail];
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->tail = (this->tail + 1) % Size;
+      }
+      return c;
+    };
+    /**
+     * Send one byte (blocking, until the transmit buffer is free).
+     */
+    size_t write(uint8_t c) final {
+      while (!(*this->ucsra & _BV(UDRE0)));
+      // clear TXC (by writing 1 to it), so flush can wait until this byte 
+      // is sent. FE, DOR and UPE must be written 0 (UDRE is read only).
+      *this->ucsra = (*this->ucsra & (_BV(U2X0) | _BV(MPCM0) | _BV(UDRE0)))
+        | _BV(TXC0);
+      *this->udr = c;
+      this->written = true;
+      return 1;
+    };
+    size_t write(const uint8_t *buffer, size_t size) final {
+      for (size_t i = 0; i < size; i++) this->write(buffer[i]);
+      return size;
+    };
+    using Print::write;
+    // The core Print::print methods are not inline, so their write calls
+    // are always virtual: the strings and the chars are printed directly.
+    using Print::print;
+    size_t print(const char str[]) {
+      return this->write((const uint8_t*)str, strlen(str));
+    };
+    size_t print(char c) { return this->write((uint8_t)c); };
+    /**
+     * Wait until the last written byte was sent: TXC is set when the 
+     * shift register is empty (UDRE only means that the last byte 
+     * was moved to the shift register, so end would cut it off).
+     */
+    void flush() final {
+      if (!this->written) return;
+      while (!(*this->ucsra & _BV(TXC0)));
+    };
+    /**
+     * Store the received byte. Called by the RX complete 
+     * interrupt routine (see UART_STREAM_ISR).
+     */
+    void rxInterrupt() {
+      // the status must be read before the data
+      uint8_t status = *this->ucsra, c = *this->udr;
+      uint16_t next = 0, count = 0;
+      // a byte with a framing error is garbage: drop it
+      if (status & _BV(FE0)) {
+        this->frameErrors++;
+        return;
+      }
+      // the USART lost bytes (the interrupt was served too late)
+      if (status & _BV(DOR0)) this->dataOverruns++;
+      next = (this->head + 1) % Size;
+      // the buffer is full: the byte is lost
+      if (next == this->tail) {
+        this->overruns++;
+        return;
+      }
+      this->buffer[this->head] = c;
+      this->head = next;
+      count = (Size + next - this->tail) % Size;
+      if (count > this->highWaterMark) this->highWaterMark = count;
+    };
+    // bytes lost because the buffer was full
+    uint16_t getOverruns() { return this->readCounter(this->overruns); };
+    // bytes lost by the USART hardware (data overrun, DOR)
+    uint16_t getDataOverruns() { 
+      return this->readCounter(this->dataOverruns); 
+    };
+    // bytes dropped because of framing errors (FE), e.g., wrong baud rate
+    uint16_t getFrameErrors() { return this->readCounter(this->frameErrors); };
+    // the maximum number of bytes stored in the buffer, so far
+    uint16_t getHighWaterMark() { 
+      return this->readCounter(this->highWaterMark); 
+    };
+    // the total number of lost bytes
+    uint16_t getLost() {
+      return this->getOverruns() + this->getDataOverruns() 
+        + this->getFrameErrors();
+    };
+    // the buffer can store at most (Size - 1) bytes
+    static constexpr uint16_t getSize() { return Size - 1; };
+  private:
+    volatile uint8_t * const ubrrh;
+    volatile uint8_t * const ubrrl;
+    volatile uint8_t * const ucsra;
+    volatile uint8_t * const ucsrb;
+    volatile uint8_t * const ucsrc;
+    volatile uint8_t * const udr;
+    uint8_t buffer[Size];
+    // head is written by the interrupt routine, tail by read
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint16_t overruns;
+    volatile uint16_t dataOverruns;
+    volatile uint16_t frameErrors;
+    volatile uint16_t highWaterMark;
+    // TXC is set only after a byte is sent, so flush must not wait for it 
+    // if nothing was written
+    bool written;
+    uint16_t readCounter(volatile uint16_t &counter) {
+      uint16_t value = 0;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        value = counter;
+      }
+      return value;
+    };
+};
+#endif
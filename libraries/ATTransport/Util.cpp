@@ -3,14 +3,18 @@
 /************************************************************************/
 /* Calculate the current MCU free memory value (in bytes)               */
 /* It works with MCUs up to 64KB RAM (uint16_t aka unsigned short type) */
-/* @return the number of free RAM bytes available                       */
+/* @return the number of free RAM bytes available (0 for the host build)*/
 /************************************************************************/
 uint16_t getFreeMCUMemory() {
+#ifdef __AVR__
   uint16_t free_memory;
   if ((uint16_t)__brkval == 0)
     return (((uint16_t)&free_memory) - ((uint16_t)&__bss_end));
   else
     return (((uint16_t)&free_memory) - ((uint16_t)__brkval));
+#else
+  return 0;
+#endif
 };
 
 /************************************************************************/
@@ -35,3 +39,19 @@ void getPMData(const char pmData[], char *&resultData, uint8_t &length) {
   while (0 != (c = pgm_read_byte(data++))) *(resultData + length++) = c;
   *(resultData + length) = '\0';
 };
+
+/************************************************************************/
+/* Get the number of decimal digits of a value, e.g., the number of     */
+/* chars used to print it (without using String)                        */
+/* @param value                                                         */
+/*          the value                                                   */
+/* @return the number of digits (1 to 5)                                */
+/************************************************************************/
+uint8_t getDigitsCount(uint16_t value) {
+  uint8_t n = 1;
+  while (value >= 10) {
+    value /= 10;
+    n++;
+  }
+  return n;
+};
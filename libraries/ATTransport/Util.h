@@ -22,5 +22,6 @@ extern void *__brkval;
 uint16_t getFreeMCUMemory();
 void getPMData( const char pmData[], char *&resultData, uint8_t &length);
 int stringToInt( char *string);
+uint8_t getDigitsCount( uint16_t value);
 
 #endif
@@ -0,0 +1,158 @@
+#include "AnalogSampler.h"
+
+AnalogSampler *analogSamplerInstance = 0;
+
+/**
+ * Constructor.
+ */
+AnalogSampler::AnalogSampler() {
+  this->count = 0;
+  this->current = 0;
+  this->next = 0;
+};
+
+/**
+ * Add an analog pin to the sampled ones. The pins are
+ * sampled round-robin, in the order they were added.
+ * @param pin
+ *          the analog pin (e.g., A0)
+ * @param oversampling
+ *          number of extra resolution bits. For every extra bit,
+ *          4 times more samples are used for one value, so the
+ *          value rate for the channel is divided by 4.
+ * @return the channel index, used to read the values,
+ *         or -1 if no more channels can be added.
+ */
+char AnalogSampler::add(uint8_t pin, uint8_t oversampling) {
+  if (this->count >= ANALOG_SAMPLER_MAX_CHANNELS) return -1;
+  // allow the use of A0, A1, etc as well as of channel numbers
+  if (pin >= A0) pin -= A0;
+  if (oversampling > ANALOG_SAMPLER_MAX_OVERSAMPLING)
+    oversampling = ANALOG_SAMPLER_MAX_OVERSAMPLING;
+  this->channels[this->count].mux = pin;
+  this->channels[this->count].oversampling = oversampling;
+  return this->count++;
+};
+
+/**
+ * Set the ADC multiplexer channel. The reference is AVcc.
+ * @param mux
+ *          the ADC channel
+ */
+void AnalogSampler::selectMux(uint8_t mux) {
+#if defined(MUX5)
+  ADCSRB = (ADCSRB & ~_BV(MUX5)) | (((mux >> 3) & 0x01) << MUX5);
+#endif
+  ADMUX = _BV(REFS0) | (mux & 0x07);
+};
+
+/**
+ * Start the ADC in free-running mode, with a conversion
+ * complete interrupt. While the sampler is active,
+ * analogRead must not be used.
+ */
+void AnalogSampler::begin() {
+  if (this->count == 0) return;
+  analogSamplerInstance = this;
+  this->current = 0;
+  this->next = 0;
+  this->selectMux(this->channels[0].mux);
+  // free-running trigger source
+  ADCSRB &= ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0));
+  // enable ADC, auto trigger and interrupt, clock prescaler 128
+  // (125KHz ADC clock for 16MHz boards, ~9600 samples/s)
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE)
+    | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  // start the first conversion
+  ADCSRA |= _BV(ADSC);
+};
+
+/**
+ * Stop the free-running mode, so analogRead can be used again.
+ */
+void AnalogSampler::end() {
+  ADCSRA &= ~(_BV(ADATE) | _BV(ADIE));
+  analogSamplerInstance = 0;
+};
+
+/**
+ * Store a conversion result. Called by the ADC interrupt.
+ * @param value
+ *          the ADC conversion result
+ */
+void AnalogSampler::sample(uint16_t value) {
+  Channel &ch = this->channels[this->current];
+  // In free-running mode, the next conversion is already started
+  // when the ISR runs, so a new channel selected now is used only
+  // for the conversion after it.
+  this->current = this->next;
+  this->next = (this->next + 1) % this->count;
+  this->selectMux(this->channels[this->next].mux);
+  // oversampling: accumulate 4^n samples...
+  ch.accumulator += value;
+  if (++ch.accumulated < (1 << (2 * ch.oversampling))) return;
+  // ...and decimate: shift right with n bits
+  ch.buffer[ch.head] = ch.accumulator >> ch.oversampling;
+  ch.head = (ch.head + 1) % ANALOG_SAMPLER_BUFFER_SIZE;
+  if (ch.count < ANALOG_SAMPLER_BUFFER_SIZE) ch.count++;
+  ch.fresh = true;
+  ch.accumulator = 0;
+  ch.accumulated = 0;
+};
+
+/**
+ * Check if new values were stored since the last read.
+ * @param channel
+ *          the channel index (as returned by AnalogSampler::add)
+ * @return true if new values are available
+ */
+bool AnalogSampler::available(uint8_t channel) {
+  return this->channels[channel].fresh;
+};
+
+/**
+ * Get the average of the latest values of a channel (non-blocking).
+ * @param channel
+ *          the channel index (as returned by AnalogSampler::add)
+ * @return the averaged value, with (10 + oversampling) bits
+ *         resolution, or 0 if no value was yet obtained
+ */
+uint16_t AnalogSampler::read(uint8_t channel) {
+  Channel &ch = this->channels[channel];
+  uint32_t sum = 0;
+  uint8_t n = 0;
+  noInterrupts();
+  n = ch.count;
+  for (uint8_t i = 0; i < n; i++) sum += ch.buffer[i];
+  ch.fresh = false;
+  interrupts();
+  if (n == 0) return 0;
+  return sum / n;
+};
+
+/**
+ * Get the latest value of a channel (non-blocking).
+ * @param channel
+ *          the channel index (as returned by AnalogSampler::add)
+ * @return the latest value, with (10 + oversampling) bits
+ *         resolution, or 0 if no value was yet obtained
+ */
+uint16_t AnalogSampler::readLatest(uint8_t channel) {
+  Channel &ch = this->channels[channel];
+  uint16_t value = 0;
+  noInterrupts();
+  if (ch.count > 0)
+    value = ch.buffer[(ch.head + ANALOG_SAMPLER_BUFFER_SIZE - 1)
+      % ANALOG_SAMPLER_BUFFER_SIZE];
+  ch.fresh = false;
+  interrupts();
+  return value;
+};
+
+/**
+ * ADC conversion complete interrupt routine.
+ */
+ISR(ADC_vect) {
+  uint16_t value = ADC;
+  if (analogSamplerInstance) analogSamplerInstance->sample(value);
+}
@@ -0,0 +1,67 @@
+#ifndef AnalogSampler_h
+#define AnalogSampler_h
+
+#if ARDUINO < 100
+#include <WProgram.h>
+#include <pins_arduino.h>
+#else
+#include <Arduino.h>
+#endif
+
+// Maximum number of sampled analog pins.
+#define ANALOG_SAMPLER_MAX_CHANNELS 4
+// Number of (decimated) values stored for every channel,
+// used to compute the averaged value. Use a power of 2.
+#define ANALOG_SAMPLER_BUFFER_SIZE 8
+// Maximum number of extra bits obtained by oversampling
+// and decimation (6 extra bits means 16 bits values).
+#define ANALOG_SAMPLER_MAX_OVERSAMPLING 6
+
+class AnalogSampler {
+  public:
+    AnalogSampler();
+    char add(uint8_t pin, uint8_t oversampling = 0);
+    void begin();
+    void end();
+    bool available(uint8_t channel);
+    uint16_t read(uint8_t channel);
+    uint16_t readLatest(uint8_t channel);
+    /**
+     * Get the resolution of the channel values.
+     * @param channel
+     *          the channel index (as returned by AnalogSampler::add)
+     * @return the number of bits of the values (10 + oversampling bits)
+     */
+    uint8_t getResolution(uint8_t channel) {
+      return 10 + this->channels[channel].oversampling;
+    };
+    void sample(uint16_t value);
+  private:
+    // Data of one sampled analog pin.
+    struct Channel {
+      // ADC multiplexer channel
+      uint8_t mux = 0;
+      // extra bits obtained by oversampling
+      uint8_t oversampling = 0;
+      // oversampling accumulator (used only by the ISR)
+      uint32_t accumulator = 0;
+      uint16_t accumulated = 0;
+      // ring buffer of decimated values
+      volatile uint16_t buffer[ANALOG_SAMPLER_BUFFER_SIZE];
+      volatile uint8_t head = 0;
+      volatile uint8_t count = 0;
+      // true if new values were stored since the last read
+      volatile bool fresh = false;
+    };
+    Channel channels[ANALOG_SAMPLER_MAX_CHANNELS];
+    uint8_t count;
+    // channel of the conversion completed when the ISR runs
+    uint8_t current;
+    // channel of the conversion started when the ISR runs
+    uint8_t next;
+    void selectMux(uint8_t mux);
+};
+
+// the sampler which owns the ADC (only one can be active)
+extern AnalogSampler *analogSamplerInstance;
+#endif
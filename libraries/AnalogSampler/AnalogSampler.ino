@@ -0,0 +1,27 @@
+#include "AnalogSampler.h"
+#define LM35DZ_PIN A0
+#define VT93N1_PIN A1
+
+AnalogSampler sampler;
+char lm35Channel = -1, vt93n1Channel = -1;
+
+void setup() {
+  // Start serial communication, used to show
+  // sensor data in the Arduino serial monitor.
+  Serial.begin(115200);
+  // sample A0 with 2 extra bits of resolution (12 bits values)
+  lm35Channel = sampler.add(LM35DZ_PIN, 2);
+  // sample A1 with the standard 10 bits resolution
+  vt93n1Channel = sampler.add(VT93N1_PIN);
+  // start sampling, in background
+  sampler.begin();
+}
+
+void loop() {
+  // read the averaged values, this never blocks
+  Serial.print("A0 (12 bits): ");
+  Serial.println(sampler.read(lm35Channel));
+  Serial.print("A1 (10 bits): ");
+  Serial.println(sampler.read(vt93n1Channel));
+  delay(1000);
+}
@@ -18,7 +18,10 @@ char Dht::readDataByte() {
     startTime = micros();
     while (digitalRead(this->pin) == LOW) {
       // separation LOW signal exceeded the timeout...
-      if (micros() - startTime > timeout) return -1;
+      if (micros() - startTime > timeout) {
+        TRACE(TRACE_EV_DHT_BIT_TIMEOUT, i);
+        return -1;
+      }
     }
     
     // read data bit
@@ -26,7 +29,10 @@ char Dht::readDataByte() {
     while (digitalRead(this->pin) == HIGH) {
       elapsedTime = micros() - startTime;
       // data bit HIGH signal exceeded the timeout...
-      if (elapsedTime > timeout) return -1;
+      if (elapsedTime > timeout) {
+        TRACE(TRACE_EV_DHT_BIT_TIMEOUT, i);
+        return -1;
+      }
     }
     
     // a bit "1" means a HIGH signal of about 70 microseconds.
@@ -73,6 +79,7 @@ bool Dht::isReadyForData() {
     // It may be that the sensor does not answer, and, which is a "Timeout" error.
     // We wait for no longer than 10 milliseconds, before we trigger a "Timeout" error.
     if ( millis() - elapsedTime > 10) {
+      TRACE(TRACE_EV_DHT_READY, 0);
       return false;
     }
   };
@@ -83,6 +90,7 @@ bool Dht::isReadyForData() {
   // We just wait for PULL DOWN
   while (digitalRead(this->pin) == HIGH);
   // sensor is ready to send the 40 bits data stream
+  TRACE(TRACE_EV_DHT_READY, 1);
   return true;
 };
 
@@ -106,12 +114,12 @@ bool Dht::checkCrc(unsigned char data[5]) {
  *         and the status (see Dht::StatueEL::xxx)
  */
 Dht::Result Dht::read() {
-  unsigned char byteNmr = 0, i = 0, integral = 0, decimal = 0, data[5];
+  unsigned char i = 0, data[5];
   char dataByte = 0;
 
-  // Check if at least two seconds passed from the last reading
+  // Check if the minimum interval (see getMinInterval) passed from the last reading
   // If not, we return the latest known value which was correctly read.
-  if (millis() - this->timestamp < 2000 && this->result.status == StatusEL::OK) {
+  if (millis() - this->timestamp < this->getMinInterval() && this->result.status == StatusEL::OK) {
     return this->result;
   }
   // store timestamp of the reading
@@ -7,6 +7,15 @@
 #else
 #include <Arduino.h>
 #endif
+// the Trace library is optional: without it, the TRACE calls are removed
+#if defined(__has_include)
+#if __has_include(<Trace.h>)
+#include <Trace.h>
+#endif
+#endif
+#ifndef TRACE
+#define TRACE(id, arg) ((void)0)
+#endif
 
 class Dht { 
   public:
@@ -62,9 +71,17 @@ class Dht {
     };
     // read data from sensor 
     Result read();
+    /**
+     * Get the minimum time between two readings, as required by the sensor 
+     * type datasheet: DHT11 ==> 1 second, DHT21 and DHT22 ==> 2 seconds.
+     * @return the minimum readings interval, in milliseconds
+     */
+    unsigned int getMinInterval() {
+      return this->type == TypeEL::DHT11 ? 1000 : 2000;
+    };
   private:
     // the timestamp of the last reading, used to determine 
-    // if the minimum 2 seconds delay between the readings 
+    // if the minimum delay between the readings (see getMinInterval)
     // was respected, if not the latest reading is returned 
     // instead of making abort  a new one
     unsigned long timestamp;
@@ -0,0 +1,74 @@
+#include "DhtCache.h"
+
+DhtCache::DhtCache(Dht &dht, unsigned long maxAge): dht(dht) {
+  this->maxAge = maxAge;
+  // the first reading is made after one minimum interval,
+  // so the sensor has time to settle after the power up
+  this->attemptTime = millis();
+  this->nextDelay = dht.getMinInterval();
+};
+
+/**
+ * Get the delay between two correct readings, such that the value
+ * is refreshed one minimum interval before it expires.
+ * @return the refresh delay, in milliseconds
+ */
+unsigned long DhtCache::getRefreshDelay() {
+  unsigned long minInterval = this->dht.getMinInterval();
+  if (this->maxAge > 2 * minInterval) {
+    return this->maxAge - minInterval;
+  }
+  return minInterval;
+};
+
+/**
+ * Read the sensor, if the cached value must be refreshed.
+ * @return true if the sensor was read, false otherwise
+ */
+bool DhtCache::update() {
+  unsigned long refreshDelay = 0;
+  if (millis() - this->attemptTime < this->nextDelay) {
+    return false;
+  }
+  Dht::Result result = this->dht.read();
+  this->attemptTime = millis();
+  this->status = result.status;
+  this->reads++;
+  refreshDelay = this->getRefreshDelay();
+  if (result.status == Dht::StatusEL::OK) {
+    this->result = result;
+    this->readTime = this->attemptTime;
+    this->failures = 0;
+    this->nextDelay = refreshDelay;
+  } else {
+    // no back-to-back retries: the retry delay starts with the minimum
+    // interval, and it is doubled after every consecutive failure
+    this->errors++;
+    if (this->failures < 8) {
+      this->failures++;
+    }
+    this->nextDelay = (unsigned long)this->dht.getMinInterval() << (this->failures - 1);
+    if (this->nextDelay > refreshDelay) {
+      this->nextDelay = refreshDelay;
+    }
+  }
+  return true;
+};
+
+/**
+ * Get the cached value, without reading the sensor.
+ * @return the last correctly read value, its age and the last reading status
+ */
+DhtCache::Value DhtCache::get() {
+  Value value;
+  value.status = this->status;
+  // no correct reading yet
+  if (this->result.status != Dht::StatusEL::OK) {
+    return value;
+  }
+  value.temperature = this->result.temperature;
+  value.humidity = this->result.humidity;
+  value.age = millis() - this->readTime;
+  value.fresh = value.age <= this->maxAge;
+  return value;
+};
@@ -0,0 +1,82 @@
+#ifndef DhtCache_h
+#define DhtCache_h
+
+#include "DHTxx.h"
+
+// default maximum age of a cached value (milliseconds)
+#define DHT_CACHE_MAX_AGE 10000
+
+/**
+ * Cache for the DHTxx readings: the sensor is read in background (call
+ * update from loop), before the cached value expires, and get returns
+ * the last correctly read value, without blocking on the sensor.
+ * The readings are never closer than the sensor minimum interval
+ * (see Dht::getMinInterval), and a failed reading is retried later,
+ * with a delay doubled after every consecutive failure.
+ * NOTE: the Dht instance must be read only via the cache.
+ */
+class DhtCache {
+  public:
+    // Define data structure which is used to denote a cached value.
+    struct Value {
+      // the last correctly read values
+      float temperature = 0.0;
+      float humidity = 0.0;
+      // milliseconds since the values were read (0 if no value was read yet)
+      unsigned long age = 0;
+      // the status of the last reading: OK, or the error of the last
+      // reading (the values are still the last correctly read ones)
+      Dht::StatusEL status = Dht::StatusEL::NONE;
+      // true if a value was read and it is not older than the maximum age
+      bool fresh = false;
+    };
+    /**
+     * Constructor: create a class instance.
+     * @param dht
+     *    the cached sensor
+     * @param maxAge
+     *    the maximum age of a cached value, in milliseconds (see setMaxAge)
+     */
+    DhtCache(Dht &dht, unsigned long maxAge = DHT_CACHE_MAX_AGE);
+    /**
+     * Read the sensor, if the cached value must be refreshed
+     * (it blocks for about 5ms, see Dht::read), otherwise returns at once.
+     * Call it from loop, as often as possible.
+     * @return true if the sensor was read, false otherwise
+     */
+    bool update();
+    /**
+     * Get the cached value, without reading the sensor.
+     * @return the last correctly read value, its age and the last reading status
+     */
+    Value get();
+    /**
+     * Set the maximum age of a cached value. The sensor is read again one
+     * minimum interval (see Dht::getMinInterval) before the value expires,
+     * so a failed reading can be retried before the expiration.
+     * @param maxAge
+     *    the maximum age, in milliseconds
+     */
+    void setMaxAge(unsigned long maxAge) { this->maxAge = maxAge; };
+    unsigned long getMaxAge() { return this->maxAge; };
+    // number of the sensor readings, and how many of them failed
+    uint16_t getReads() { return this->reads; };
+    uint16_t getErrors() { return this->errors; };
+  private:
+    Dht &dht;
+    // the last correctly read values
+    Dht::Result result;
+    // the last reading status
+    Dht::StatusEL status = Dht::StatusEL::NONE;
+    unsigned long maxAge;
+    // the timestamps of the last correct reading and of the last reading
+    unsigned long readTime = 0;
+    unsigned long attemptTime;
+    // the delay from the last reading to the next one
+    unsigned long nextDelay;
+    uint8_t failures = 0;
+    uint16_t reads = 0;
+    uint16_t errors = 0;
+    unsigned long getRefreshDelay();
+};
+#endif
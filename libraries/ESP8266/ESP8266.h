@@ -1,18 +1,23 @@
 #ifndef __ESP8266_H__
 #define __ESP8266_H__
 
-#include "Util.h"
+#include <ATTransport.h>
 #include <SoftwareSerial.h>
 #include <Arduino.h>
 
-class ESP8266 {
+// maximum time (in milliseconds) to wait for the next byte of the
+// incoming data (+IPD), before the data is considered lost
+#define ESP8266_IPD_TIMEOUT 100
+
+/**
+ * ESP8266 driver, for any transport providing the Stream methods (see
+ * ATTransportT), e.g., ESP8266T<HardwareSerial> for the hardware UART.
+ * ESP8266 is the driver for any Stream.
+ */
+template <class Transport>
+class ESP8266T: public ATTransportT<Transport> {
   public:
-    enum class Error {
-      NONE = 0,
-      TIMEOUT = 1,
-      EMPTY_DATA,
-      EMPTY_STREAM
-    };
+    typedef ATTransportBase::Error Error;
     enum class LinkId {
       ID_0 = 0,
       ID_1 = 1,
@@ -54,17 +59,12 @@ class ESP8266 {
       WPA2_PSK = 3,
       WPA_WPA2_PSK = 4
     };
-    ESP8266( HardwareSerial& ser): serial( ser){
-      // allocate space for the longest command (32 chars + '\0')
-      this->cmdData = "                                 ";
-      this->cmdLen = 0;
-      this->cTime = 0;
-    };
-    void clearSerialBuffer();
+    ESP8266T( Transport& ser): ATTransportT<Transport>( ser) {};
     Error at(uint16_t timeout = 500);
     Error ate0(uint16_t timeout = 500);
     Error ate1(uint16_t timeout = 500);
     Error atRst(uint16_t timeout = 2000);
+    Error waitReady(uint16_t timeout = 3000);
     Error atCwmode(WiFiMode mode = WiFiMode::STA, 
       uint16_t timeout = 500);
     Error atCwsap(char* ssid, char* passwd, 
@@ -80,38 +80,37 @@ class ESP8266 {
       uint16_t timeout = 5000);
     Error atCipclose(LinkId linkId = LinkId::NONE, 
       uint16_t timeout = 1000);
+    Error atCipmux(bool multiple = true, uint16_t timeout = 500);
+    Error atCipserver(bool enable = true, uint16_t port = 80, 
+      uint16_t timeout = 1000);
+    Error atCipsto(uint16_t serverTimeout = 30, uint16_t timeout = 500);
+    Error ipdHeader(uint16_t &dataLen, LinkId &linkId, 
+      uint16_t waitTime = 0);
+    int ipdRead(uint16_t timeout = ESP8266_IPD_TIMEOUT);
     Error ipd(char *&data, uint16_t &dataLen, LinkId &linkId, 
       uint16_t waitTime = 0);
     inline Error ipd(char *&data, LinkId &linkId, uint16_t waitTime = 0) {
       uint16_t dataLen = 0;
-      return this->ipd(data, dataLen, linkId);
+      return this->ipd(data, dataLen, linkId, waitTime);
     };
     inline Error ipd(char *&data, uint16_t &dataLen, uint16_t waitTime = 0) {
-      ESP8266::LinkId linkId = ESP8266::LinkId::NONE;
-      return this->ipd(data, dataLen, linkId);
+      LinkId linkId = LinkId::NONE;
+      return this->ipd(data, dataLen, linkId, waitTime);
     };
     /*inline Error ipd(char *&data, uint16_t waitTime = 0) {
       uint16_t dataLen = 0;
-      ESP8266::LinkId linkId = ESP8266::LinkId::NONE;
+      LinkId linkId = LinkId::NONE;
       return this->ipd(data, dataLen, linkId);
     };*/
     
     Error atCipsend(char *data, LinkId linkId = LinkId::NONE, 
       uint16_t timeout = 1000);
+    Error atCipsend(const uint8_t *data, uint16_t dataLen, 
+      LinkId linkId = LinkId::NONE, uint16_t timeout = 1000);
     Error atCipsendHttpGet(char *path, char *data, 
       LinkId linkId = LinkId::NONE, uint16_t timeout = 1000);
     Error atCipsendHttpPost(char *path, char *data, 
       LinkId linkId = LinkId::NONE, uint16_t timeout = 1000);
-
-  private:
-    char *cmdData;
-    uint8_t cmdLen;
-    uint32_t cTime;
-    HardwareSerial& serial;
-    Error checkTimeout(const char* response, uint16_t timeout);
-    inline Error checkTimeout(const char response, uint16_t timeout) {
-      return this->checkTimeout((const char*) response, timeout);
-    };
 };
 // constants stored in Program Memory (FLASH)
 const char ESP8266_PGM_AT[] PROGMEM = "AT";
@@ -126,6 +125,9 @@ const char ESP8266_PGM_AT_CIPSTART[] PROGMEM = "AT+CIPSTART";
 const char ESP8266_PGM_AT_CIPSTART_CONNECT_OK[] PROGMEM = "CONNECT\r\n\r\nOK\r\n";
 const char ESP8266_PGM_AT_CIPCLOSE[] PROGMEM = "AT+CIPCLOSE";
 const char ESP8266_PGM_AT_CIPCLOSE_CLOSED[] PROGMEM = "CLOSED";
+const char ESP8266_PGM_AT_CIPMUX[] PROGMEM = "AT+CIPMUX";
+const char ESP8266_PGM_AT_CIPSERVER[] PROGMEM = "AT+CIPSERVER";
+const char ESP8266_PGM_AT_CIPSTO[] PROGMEM = "AT+CIPSTO";
 const char ESP8266_PGM_IPD[] PROGMEM = "+IPD";
 const char ESP8266_PGM_GOT_IP[] PROGMEM = "GOT IP";
 const char ESP8266_PGM_AT_CIPSEND[] PROGMEM = "AT+CIPSEND";
@@ -151,4 +153,726 @@ const char ESP8266_COLON = ':';
 const char ESP8266_SEMI_COLON = ';';
 const char ESP8266_WHITE_SPACE = ' ';
 const char ESP8266_GREATER_THAN = '>';
+// the driver for any Stream (e.g., Serial or a SoftwareSerial)
+typedef ESP8266T<Stream> ESP8266;
+
+/************************************************************************/
+/* @method                                                              */
+/* Software check if ESP8266 module is ok: send AT command              */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::at(uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT, this->cmdData, this->cmdLen);
+  // send AT command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Disable echo: send ATE0 command                                      */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::ate0(uint16_t timeout) {
+  getPMData(ESP8266_PGM_ATE0, this->cmdData, this->cmdLen);
+  // send ATE0 command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Enable echo: send ATE1 command                                       */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::ate1(uint16_t timeout) {
+  getPMData(ESP8266_PGM_ATE1, this->cmdData, this->cmdLen);
+  // send ATE1 command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Software reset he ESP8266 module: send AT+RST command                */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 1000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atRst(uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_RST, this->cmdData, this->cmdLen);
+  // send AT+RST command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CMD_END);
+  getPMData(ESP8266_PGM_AT_RST_READY, this->cmdData, this->cmdLen);
+  return this->checkTimeout(this->cmdData, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Wait for the ESP8266 module to boot, e.g., after a hardware reset    */
+/* (RST pin) or a power cycle                                           */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for the "ready" message     */
+/*          NOTE: default value is 3000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::waitReady(uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_RST_READY, this->cmdData, this->cmdLen);
+  return this->checkTimeout(this->cmdData, timeout);
+};
+
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the WiFi mode: send AT+CWMODE command                            */
+/* @param mode                                                          */
+/*          the WiFi mode (STA, AP or STA+AP), values of WiFiMode::xxx  */
+/*          Defaults to STA.                                            */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCwmode(
+  WiFiMode mode, uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_CWMODE, this->cmdData, this->cmdLen);
+  // send AT+CWMODE=mode command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print((uint8_t)mode);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Access point settings: execute AT+CWSAP                              */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 2000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCwsap(char* ssid, char* passwd, 
+  Channel channel, Encription enc, uint16_t timeout) {
+    
+  getPMData(ESP8266_PGM_AT_CWSAP, this->cmdData, this->cmdLen);
+  // send AT+CWSAP command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ssid);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(passwd);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print((uint8_t)channel);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print((uint8_t)enc);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Client  settings: execute AT+CWJAP                                   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 2000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCwjap(
+  const char* ssid, const char* passwd, uint16_t timeout) {
+
+  getPMData(ESP8266_PGM_AT_CWJAP, this->cmdData, this->cmdLen);
+  // send AT+CWSAP command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ssid);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(passwd);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+
+/************************************************************************/
+/* @method                                                              */
+/* Execute AT+CIPSTART for UDP                                          */
+/* @param remoteIp                                                      */
+/*          the IP of the remote side for the udp connection            */
+/* @param remotePort                                                    */
+/*          the port of the remote side for the udp connection          */
+/* @param localPort                                                     */
+/*          the local port for the udp connection                       */
+/* @param udpMode                                                       */
+/*          the udp mode (see ESP8266::UdpMode::XXX                     */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 5000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipstartUdp(
+  char* remoteIp, uint16_t remotePort, uint16_t localPort, UdpMode mode,
+  uint16_t timeout) {
+
+  getPMData(ESP8266_PGM_AT_CIPSTART, this->cmdData, this->cmdLen);
+  // send AT+CIPSTART command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_UDP);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(remoteIp);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(remotePort);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(localPort);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print((uint8_t) mode);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Execute AT+CIPSTART for TCP                                          */
+/* @param remoteIp                                                      */
+/*          the IP of the remote side for the tcp connection            */
+/* @param remotePort                                                    */
+/*          the port of the remote side for the tcp connection          */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 5000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipstartTcp(const char* remoteIp, 
+  uint16_t remotePort, uint16_t timeout) {
+
+  getPMData(ESP8266_PGM_AT_CIPSTART, this->cmdData, this->cmdLen);
+  // send AT+CIPSTART command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_TCP);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(remoteIp);
+  this->serial.print(ESP8266_DQUOTE);
+  this->serial.print(ESP8266_COMA);
+  this->serial.print(remotePort);
+  this->serial.print(ESP8266_CMD_END);
+  getPMData(ESP8266_PGM_AT_CIPSTART_CONNECT_OK, this->cmdData, this->cmdLen);
+  return this->checkTimeout(this->cmdData, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Close TCP/UDP connection (AT+CIPCLOSE command)                       */
+/* @param linkId                                                        */
+/*          the link ID of the connection to close (LinkId::xxx values) */
+/*          NOTE: skip this param when CIPMUX = 0. If CIMUX = 1, use    */ 
+/*                the value LinkId::ID_ALL to close all connections.    */
+/*                (CIPMUX must be 1) to close all connections.          */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for CLOSEDresponse before gave up)                          */
+/*          NOTE: default value is 1000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipclose(
+  LinkId linkId, uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_CIPCLOSE, this->cmdData, this->cmdLen);
+  // send AT+CIPCLOSE command
+  this->serial.print(this->cmdData);
+  if (linkId <= LinkId::ALL) {
+    this->serial.print(ESP8266_EQUAL);
+    this->serial.print((int)linkId);
+  }
+  this->serial.print(ESP8266_CMD_END);
+  getPMData(ESP8266_PGM_AT_CIPCLOSE_CLOSED, this->cmdData, this->cmdLen);
+  return this->checkTimeout(this->cmdData, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Enable or disable multiple connections (AT+CIPMUX command)           */
+/* @param multiple                                                      */
+/*          true for multiple connections (CIPMUX = 1, required by the  */
+/*          server mode), false for a single connection (CIPMUX = 0)    */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipmux(
+  bool multiple, uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_CIPMUX, this->cmdData, this->cmdLen);
+  // send AT+CIPMUX command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(multiple ? 1 : 0);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Start or stop the TCP server (AT+CIPSERVER command)                  */
+/* NOTE: the server requires multiple connections (see atCipmux)        */
+/* @param enable                                                        */
+/*          true to start the server, false to stop it                  */
+/* @param port                                                          */
+/*          the server port                                             */
+/*          NOTE: default value is 80                                   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 1000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipserver(
+  bool enable, uint16_t port, uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_CIPSERVER, this->cmdData, this->cmdLen);
+  // send AT+CIPSERVER command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(enable ? 1 : 0);
+  if (enable) {
+    this->serial.print(ESP8266_COMA);
+    this->serial.print(port);
+  }
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the server timeout (AT+CIPSTO command): idle client connections  */
+/* are closed by the module after this time                             */
+/* @param serverTimeout                                                 */
+/*          the server timeout in seconds (0 - 7200)                    */
+/*          NOTE: default value is 30                                   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipsto(
+  uint16_t serverTimeout, uint16_t timeout) {
+  getPMData(ESP8266_PGM_AT_CIPSTO, this->cmdData, this->cmdLen);
+  // send AT+CIPSTO command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(serverTimeout);
+  this->serial.print(ESP8266_CMD_END);
+  return this->checkTimeout(ESP8266_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Receive data (+IPD)                                                  */
+/* @param data                                                          */
+/*          reference parameter storing the received data               */
+/* @param dataLen                                                       */
+/*          reference parameter storing the received data length        */
+/* @param linkId                                                        */
+/*          link ID reference of the connection (LinkId::xxx values)    */
+/*          NOTE: this is LinkId::NONE when CIPMUX = 0. If CIMUX = 1,   */ 
+/*                the value is LinkId::ID_X (x = [0, 4]).               */
+/* @param waitTime                                                      */
+/*          timeout in milliseconds to wait for data (blocking!)        */
+/*          NOTE: default value is 0                                    */
+/* @return ESP8266::Error_NONE if all OK (dataLen is 0 if there was no  */
+/*         data), ESP8266::Error::DATA_LOST if less data than announced */
+/*         was received (dataLen is the received length), or another    */
+/*         ESP8266::Error::XXX value otherwise                          */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::ipd(
+  char *&data, uint16_t &dataLen, LinkId &linkId, uint16_t waitTime) {
+    
+  Error error = Error::NONE;
+  uint16_t i = 0;
+  int c = 0;
+  // read the "+IPD,[linkId,]dataLen:" header
+  error = this->ipdHeader(dataLen, linkId, waitTime);
+  if (error != Error::NONE) return error;
+  if (dataLen == 0) return Error::NONE;
+  // now extract received data, which may still be arriving
+  for (i = 0; i < dataLen; i++) {
+    if ((c = this->ipdRead()) < 0) break;
+    *(data + i) = c;
+  }
+  *(data + i) = '\0';
+  TRACE(TRACE_EV_IPD_END, i);
+  // the data was truncated (e.g., the serial buffer overflowed)
+  if (i < dataLen) {
+    dataLen = i;
+    return Error::DATA_LOST;
+  }
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Receive the header of the incoming data: "+IPD,[linkId,]dataLen:".   */
+/* The data itself is left in the serial buffer, so it can be read with */
+/* ipdRead, e.g., only the needed part of it is stored.                 */
+/* @param dataLen                                                       */
+/*          reference parameter storing the incoming data length, or 0  */
+/*          if no data was received in the wait time                    */
+/* @param linkId                                                        */
+/*          link ID reference of the connection (LinkId::xxx values)    */
+/*          NOTE: this is LinkId::NONE when CIPMUX = 0. If CIMUX = 1,   */ 
+/*                the value is LinkId::ID_X (x = [0, 4]).               */
+/* @param waitTime                                                      */
+/*          timeout in milliseconds to wait for data (blocking!)        */
+/*          NOTE: default value is 0                                    */
+/* @return ESP8266::Error_NONE if all OK (dataLen is 0 if no data, or   */
+/*         only other lines, e.g., "0,CONNECT", were received), or      */
+/*         ESP8266::Error::XXX otherwise                                */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::ipdHeader(
+  uint16_t &dataLen, LinkId &linkId, uint16_t waitTime) {
+    
+  int c = 0;
+  uint8_t matched = 0;
+  uint16_t value = 0;
+  uint32_t start = millis();
+  // be sure that the reference values are reset
+  dataLen = 0;
+  linkId = LinkId::NONE;
+  // ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_IPD, this->cmdData, this->cmdLen);
+  // drop the received lines until "+IPD" (e.g., "0,CONNECT", "0,CLOSED" 
+  // or "OK"), without waiting for more data once they are read. The 
+  // wait time applies only until a "+IPD" header starts.
+  while (this->cmdData[matched] != '\0') {
+    if (matched > 0) c = this->ipdRead();
+    else if (this->serial.available()) c = this->serial.read();
+    else if (millis() - start >= waitTime) return Error::NONE;
+    else continue;
+    if (c < 0) return Error::EMPTY_STREAM;
+    if (c == this->cmdData[matched]) matched++;
+    else matched = (c == this->cmdData[0]) ? 1 : 0;
+  }
+  // next char is 'coma', so just drop it
+  if (this->ipdRead() != ESP8266_COMA) return Error::EMPTY_STREAM;
+  // next is the optional link ID and a coma (CIPMUX = 1), then 
+  // 1 to 4 digits representing the data length (0-2048)
+  while ((c = this->ipdRead()) >= 0 && c != ':') {
+    if (c == ESP8266_COMA) {
+      linkId = (LinkId)value;
+      value = 0;
+    } else value = value * 10 + c - '0';
+  }
+  if (c != ':') return Error::EMPTY_STREAM;
+  dataLen = value;
+  TRACE(TRACE_EV_IPD_START, dataLen);
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Read one byte of the incoming data (see ipdHeader)                   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for the byte                */
+/*          NOTE: default value is 100                                  */
+/* @return the byte value, or -1 if no byte was received                */
+/************************************************************************/
+template <class Transport>
+int ESP8266T<Transport>::ipdRead(uint16_t timeout) {
+  uint32_t start = millis();
+  while (!this->serial.available())
+    if (millis() - start > timeout) return -1;
+  return this->serial.read();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send TCP/UDP data (execute AT+CIPSEND command)                       */
+/* @param data                                                          */
+/*          data to send (must be \0 terminated!), the \0 is not sent   */
+/* @param linkId                                                        */
+/*          the connection ID (obtained when AT+CIPSTART executed)      */
+/*          NOTE: this must be LinkId::NONE (default value) if the      */
+/*                value of CIPMUX = 0 and LinkId::ID_x if CIPMUX = 1    */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for SEND OK answer          */
+/*          NOTE: default value is 2000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipsend(
+  char *data, LinkId linkId, uint16_t timeout) {
+  // exactly strlen(data) bytes are announced and sent (no \0, no CR LF)
+  return this->atCipsend((const uint8_t*)data, strlen(data), linkId, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send binary TCP/UDP data (execute AT+CIPSEND command)                */
+/* @param data                                                          */
+/*          data to send (may contain any byte value, including 0)      */
+/* @param dataLen                                                       */
+/*          the number of bytes to send (maximum 2048)                  */
+/* @param linkId                                                        */
+/*          the connection ID (obtained when AT+CIPSTART executed)      */
+/*          NOTE: this must be LinkId::NONE (default value) if the      */
+/*                value of CIPMUX = 0 and LinkId::ID_x if CIPMUX = 1    */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for SEND OK answer          */
+/*          NOTE: default value is 1000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipsend(
+  const uint8_t *data, uint16_t dataLen, LinkId linkId, uint16_t timeout) {
+    
+  Error error = Error::NONE;
+  long remainingTimeout = 0;
+  // data to be send is empty...
+  if (dataLen < 1) return Error::EMPTY_DATA;
+  // ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND, this->cmdData, this->cmdLen);
+  // send AT+CIPSEND=[linkId,]dataLen command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  if (linkId < LinkId::ALL) {
+    this->serial.print((int)linkId);
+    this->serial.print(ESP8266_COMA);
+  }
+  this->serial.print(dataLen); 
+  this->serial.print(ESP8266_CMD_END);
+  // start recording elapsed time
+  this->cTime = millis();
+  // wait for OK
+  error = this->checkTimeout(ESP8266_OK, timeout);
+  if (error != Error::NONE) return error;
+  // wait for '>'
+  remainingTimeout = timeout - (millis() - this->cTime);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  error = this->checkTimeout(ESP8266_GREATER_THAN, remainingTimeout);
+  if (error != Error::NONE) return error;
+  // send data, exactly dataLen bytes (no line end)
+  this->serial.write(data, dataLen);
+  // wait for SEND OK
+  remainingTimeout = timeout - (millis() - this->cTime);
+  // ESP8266 "SEND OK" string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND_SEND_OK, this->cmdData, this->cmdLen);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  return this->checkTimeout(this->cmdData, remainingTimeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send HTTP GET request                                                */
+/* @param data                                                          */
+/*          data to send (must be \0 terminated!)                       */
+/* @param linkId                                                        */
+/*          the connection ID (obtained when AT+CIPSTART executed)      */
+/*          NOTE: this must be LinkId::NONE (default value) if the      */
+/*                value of CIPMUX = 0 and LinkId::ID_x if CIPMUX = 1    */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for SEND OK answer          */
+/*          NOTE: default value is 2000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipsendHttpGet(
+  char *path, char *data, LinkId linkId, uint16_t timeout) {
+    
+  Error error = Error::NONE;
+  uint16_t dataLen = 0, pathLen = 0;
+  char *pData = data;
+  long remainingTimeout = 0;
+  // compute lengt of the data to be sent
+  while ((*(pData + dataLen++)) != 0);
+  dataLen--;
+  // compute lengt of the path where to send
+  pData = path;
+  while ((*(pData + pathLen++)) != 0);
+  pathLen--;
+  // ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND, this->cmdData, this->cmdLen);
+  // data to be send is empty...
+  if (dataLen < 1) return Error::EMPTY_DATA;
+  // send AT+CIPSEND command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  // 17 = length(ESP8266_HTTP_HEADER + ESP8266_HTTP_GET + separator spaces)
+  this->serial.print(pathLen + dataLen + 17);   
+  this->serial.print(ESP8266_CMD_END);
+  // start recording elapsed time
+  this->cTime = millis();
+  // wait for OK
+  error = this->checkTimeout(ESP8266_OK, timeout);
+  if (error != Error::NONE) return error;
+  // wait for '>'
+  remainingTimeout = timeout - (millis() - this->cTime);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  error = this->checkTimeout(ESP8266_GREATER_THAN, remainingTimeout);
+  if (error != Error::NONE) return error;
+  // send data
+  // ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_HTTP_GET, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  this->serial.print(path);
+  this->serial.print(data);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  getPMData(ESP8266_PGM_HTTP_VERSION, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CR_LF);
+  this->serial.print(ESP8266_CR_LF);
+  this->serial.print(ESP8266_CMD_END);
+  // wait for SEND OK
+  remainingTimeout = timeout - (millis() - this->cTime);
+  // ESP8266 "SEND OK" string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND_SEND_OK, this->cmdData, this->cmdLen);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  return this->checkTimeout(this->cmdData, remainingTimeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send HTTP GET request                                                */
+/* @param data                                                          */
+/*          data to send (must be \0 terminated!)                       */
+/* @param linkId                                                        */
+/*          the connection ID (obtained when AT+CIPSTART executed)      */
+/*          NOTE: this must be LinkId::NONE (default value) if the      */
+/*                value of CIPMUX = 0 and LinkId::ID_x if CIPMUX = 1    */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for SEND OK answer          */
+/*          NOTE: default value is 2000                                 */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266T<Transport>::atCipsendHttpPost(
+  char *path, char *data, LinkId linkId, uint16_t timeout) {
+    
+  Error error = Error::NONE;
+  // 81 = length(HTTP POST, version, headers and separators)
+  uint16_t dataLen = 0, pathLen = 0, baseLen = 81;
+  char *pData = data;
+  long remainingTimeout = 0;
+  // compute lengt of the data to be sent
+  while ((*(pData + dataLen++)) != 0);
+  dataLen--;
+  // data to be send is empty...
+  if (dataLen < 1) return Error::EMPTY_DATA;
+  // compute lengt of the path where to send
+  pData = path;
+  while ((*(pData + pathLen++)) != 0);
+  pathLen--;
+  // add the number of chars used to represent the value of Content-length
+  baseLen += getDigitsCount(dataLen);
+  /**
+   * a POST request example is shown below:
+   *
+   * POST /path HTTP/1.1\n
+   * Content-Length: 14\n
+   * Content-Type: application/x-www-form-urlencoded\n\n
+   * temperature=25
+   */
+  //ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND, this->cmdData, this->cmdLen);
+  // send AT+CIPSEND command
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_EQUAL);
+  this->serial.print(pathLen + dataLen + baseLen);     
+  this->serial.print(ESP8266_CMD_END);
+  // start recording elapsed time
+  this->cTime = millis();
+  // wait for OK
+  error = this->checkTimeout(ESP8266_OK, timeout);
+  if (error != Error::NONE) return error;
+  // wait for '>'
+  remainingTimeout = timeout - (millis() - this->cTime);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  error = this->checkTimeout(ESP8266_GREATER_THAN, remainingTimeout);
+  if (error != Error::NONE) return error;
+  // send data
+  // ESP8266 command string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_HTTP_POST, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  this->serial.print(path);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  getPMData(ESP8266_PGM_HTTP_VERSION, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CR_LF);
+  getPMData(ESP8266_PGM_HTTP_HEADER_CONTENT_LENGTH, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_COLON);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  this->serial.print(dataLen);
+  this->serial.print(ESP8266_CR_LF);
+  getPMData(ESP8266_PGM_HTTP_HEADER_CONTENT_TYPE, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_COLON);
+  this->serial.print(ESP8266_WHITE_SPACE);
+  getPMData(ESP8266_PGM_HTTP_HEADER_CONTENT_TYPE_FORM_URLENCODED, this->cmdData, this->cmdLen);
+  this->serial.print(this->cmdData);
+  this->serial.print(ESP8266_CR_LF);
+  this->serial.print(ESP8266_CR_LF);
+  this->serial.print(data);
+  // wait for SEND OK
+  remainingTimeout = timeout - (millis() - this->cTime);
+  // ESP8266 "SEND OK" string is loaded from PROGMEM
+  getPMData(ESP8266_PGM_AT_CIPSEND_SEND_OK, this->cmdData, this->cmdLen);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  return this->checkTimeout(this->cmdData, remainingTimeout);
+};
 #endif
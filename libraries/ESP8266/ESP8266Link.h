@@ -0,0 +1,531 @@
+/*
+ * ESP8266 link supervisor: periodic liveness probes and a bounded,
+ * non-blocking recovery (escalation ladder with exponential backoff).
+ *
+ * @file ESP8266Link.h
+ * @version 1.0
+ */
+#ifndef __ESP8266_LINK_H__
+#define __ESP8266_LINK_H__
+
+#include "ESP8266.h"
+
+// time between two liveness probes (AT), when no traffic is reported
+#define ESP8266_LINK_PROBE_INTERVAL 10000
+// timeout of a liveness probe (milliseconds)
+#define ESP8266_LINK_PROBE_TIMEOUT 200
+// time until a failed probe is repeated (milliseconds)
+#define ESP8266_LINK_PROBE_RETRY 250
+// maximum time a probe or a recovery step waits for the sketch to read
+// the pending received data (milliseconds), see update
+#define ESP8266_LINK_INPUT_WAIT 1000
+// consecutive failures (probes or reported) that mean the link is down
+#define ESP8266_LINK_PROBE_FAILURES 2
+// recovery attempts at one ladder level, before the next level is used
+#define ESP8266_LINK_LEVEL_ATTEMPTS 2
+// delay between the recovery attempts: doubled after every failed
+// attempt, then a random part (up to half of it) is removed (jitter)
+#define ESP8266_LINK_MIN_BACKOFF 500
+#define ESP8266_LINK_MAX_BACKOFF 60000
+// the link must be up for this time (milliseconds) before the ladder
+// starts again from the first level, after a recovery
+#define ESP8266_LINK_STABLE_TIME 60000
+// hardware reset: reset pin LOW pulse length and boot timeout
+#define ESP8266_LINK_RESET_PULSE 10
+#define ESP8266_LINK_BOOT_TIMEOUT 3000
+
+/**
+ * Supervises the ESP8266 link, without blocking the sketch for longer
+ * than one recovery step: the module is probed with AT every few
+ * seconds (or less, if the sketch reports the successful sends), and
+ * a down link is recovered by the next level of the ladder:
+ * AT, reconnect (AT+CIPCLOSE and AT+CIPSTART), join the access point
+ * again (AT+CWJAP), software reset (AT+RST), hardware reset (RST pin).
+ * The levels which are not configured are skipped.
+ */
+template <class Transport>
+class ESP8266LinkT {
+  public:
+    typedef ATTransportBase::Error Error;
+    enum class State: uint8_t {
+      // UP ==> the module answers (the last probe or send was OK)
+      UP = 0,
+      // SUSPECT ==> a probe or send failed, the probe is repeated soon
+      SUSPECT = 1,
+      // DOWN ==> recovering the link (see getLevel)
+      DOWN = 2
+    };
+    // the escalation ladder levels
+    enum class Level: uint8_t {
+      NONE = 0,
+      AT = 1,
+      RECONNECT = 2,
+      REJOIN = 3,
+      RESET = 4,
+      HARD_RESET = 5
+    };
+    ESP8266LinkT(ESP8266T<Transport> &esp);
+    void setAccessPoint(const char *ssid, const char *passwd);
+    void setServer(const char *host, uint16_t port);
+    void setResetPin(uint8_t pin);
+    /**
+     * Set the function called after every module reset (e.g., to
+     * configure again the server mode, which is lost after a reset).
+     */
+    void setResetHandler(void (*handler)()) {
+      this->resetHandler = handler;
+    };
+    void setProbeInterval(uint16_t interval) {
+      this->probeInterval = interval;
+    };
+    void begin();
+    State update();
+    bool waitUp(uint32_t timeout);
+    void reportSuccess();
+    void reportFailure();
+    bool isUp() { return this->state != State::DOWN; };
+    State getState() { return this->state; };
+    // the last used ladder level (NONE if the link is stable)
+    Level getLevel() { return this->level; };
+    // statistics
+    uint16_t getDetections() { return this->detections; };
+    uint16_t getRecoveries() { return this->recoveries; };
+    uint32_t getAttempts() { return this->attempts; };
+    // detection time: from the last proof of life to the detection
+    uint32_t getLastDetectTime() { return this->lastDetectTime; };
+    uint32_t getMaxDetectTime() { return this->maxDetectTime; };
+    // recovery time: from the detection to the link being up again
+    uint32_t getLastRecoverTime() { return this->lastRecoverTime; };
+    uint32_t getMaxRecoverTime() { return this->maxRecoverTime; };
+    uint32_t getMeanRecoverTime() {
+      return this->recoveries ? this->recoverTimeSum / this->recoveries : 0;
+    };
+  private:
+    ESP8266T<Transport> &esp;
+    const char *ssid;
+    const char *passwd;
+    const char *host;
+    uint16_t port;
+    int16_t resetPin;
+    void (*resetHandler)();
+    uint16_t probeInterval;
+    State state;
+    Level level;
+    // the initial join is not counted in the statistics
+    bool starting;
+    uint8_t failures;
+    uint8_t levelAttempts;
+    uint8_t backoffStep;
+    bool inputPending;
+    uint32_t inputSince;
+    uint32_t lastProbe;
+    uint32_t lastOk;
+    uint32_t upSince;
+    uint32_t detectedAt;
+    uint32_t nextAttempt;
+    // statistics
+    uint16_t detections;
+    uint16_t recoveries;
+    uint32_t attempts;
+    uint32_t lastDetectTime;
+    uint32_t maxDetectTime;
+    uint32_t lastRecoverTime;
+    uint32_t maxRecoverTime;
+    uint32_t recoverTimeSum;
+    void probe();
+    bool isInputPending(uint32_t now);
+    void failed();
+    void down(Level first);
+    void up();
+    void recover();
+    bool isAvailable(Level level);
+    Level next(Level level);
+    Error restore(Level level);
+};
+// the link supervisor for the ESP8266 driver for any Stream
+typedef ESP8266LinkT<Stream> ESP8266Link;
+
+/************************************************************************/
+/* @constructor                                                         */
+/* @param esp                                                           */
+/*          the supervised ESP8266 module                               */
+/************************************************************************/
+template <class Transport>
+ESP8266LinkT<Transport>::ESP8266LinkT(
+  ESP8266T<Transport> &esp): esp(esp) {
+  this->ssid = 0;
+  this->passwd = 0;
+  this->host = 0;
+  this->port = 0;
+  this->resetPin = -1;
+  this->resetHandler = 0;
+  this->probeInterval = ESP8266_LINK_PROBE_INTERVAL;
+  this->state = State::UP;
+  this->level = Level::NONE;
+  this->starting = false;
+  this->failures = 0;
+  this->levelAttempts = 0;
+  this->backoffStep = 0;
+  this->inputPending = false;
+  this->inputSince = 0;
+  this->lastProbe = 0;
+  this->lastOk = 0;
+  this->upSince = 0;
+  this->detectedAt = 0;
+  this->nextAttempt = 0;
+  this->detections = 0;
+  this->recoveries = 0;
+  this->attempts = 0;
+  this->lastDetectTime = 0;
+  this->maxDetectTime = 0;
+  this->lastRecoverTime = 0;
+  this->maxRecoverTime = 0;
+  this->recoverTimeSum = 0;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the WiFi access point, used to join it again (REJOIN level)      */
+/* @param ssid                                                          */
+/*          the access point SSID                                       */
+/* @param passwd                                                        */
+/*          the access point password                                   */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::setAccessPoint(
+  const char *ssid, const char *passwd) {
+  this->ssid = ssid;
+  this->passwd = passwd;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the server of a permanent TCP connection, used to connect to it  */
+/* again (RECONNECT level). Don't use it if the connections are opened  */
+/* and closed by the sketch, or by a client (e.g., ESP8266Mqtt).        */
+/* @param host                                                          */
+/*          the IP or the domain name of the server                     */
+/* @param port                                                          */
+/*          the server port                                             */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::setServer(const char *host, uint16_t port) {
+  this->host = host;
+  this->port = port;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the pin connected to the ESP8266 RST pin (HARD_RESET level)      */
+/* @param pin                                                           */
+/*          the pin number (the pin is kept HIGH, and set LOW for       */
+/*          ESP8266_LINK_RESET_PULSE milliseconds to reset the module)  */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::setResetPin(uint8_t pin) {
+  this->resetPin = pin;
+  digitalWrite(pin, HIGH);
+  pinMode(pin, OUTPUT);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Start the supervision: the access point is joined (and the server is */
+/* connected) by the next update calls, with the same bounded retries   */
+/* as for a recovery, so the sketch is never blocked for long.          */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::begin() {
+  this->starting = true;
+  this->level = Level::NONE;
+  this->down(this->isAvailable(Level::REJOIN) ? Level::REJOIN
+    : this->isAvailable(Level::RECONNECT) ? Level::RECONNECT : Level::AT);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Supervise the link: probe it (if the probe interval elapsed), or try */
+/* the next recovery step (if the backoff delay elapsed). Call it from  */
+/* the loop method, as often as possible.                               */
+/* NOTE: it blocks at most for the command timeouts of one step (e.g.,  */
+/*       about 20 seconds for a RESET with REJOIN and RECONNECT).       */
+/* NOTE: the command responses are found by skipping the received      */
+/*       data, so no probe or recovery step is made while received data */
+/*       (e.g., a +IPD frame) is pending: the sketch must read it first */
+/*       (for up to ESP8266_LINK_INPUT_WAIT milliseconds).              */
+/* @return the link state                                               */
+/************************************************************************/
+template <class Transport>
+typename ESP8266LinkT<Transport>::State ESP8266LinkT<Transport>::update() {
+  uint32_t now = millis();
+  bool due = false;
+  switch (this->state) {
+    case State::UP:
+      // stable again: the next failure starts from the first level
+      if (this->level != Level::NONE
+        && now - this->upSince >= ESP8266_LINK_STABLE_TIME) {
+        this->level = Level::NONE;
+        this->backoffStep = 0;
+      }
+      due = now - this->lastProbe >= this->probeInterval;
+      break;
+    case State::SUSPECT:
+      due = now - this->lastProbe >= ESP8266_LINK_PROBE_RETRY;
+      break;
+    case State::DOWN:
+      due = (int32_t)(now - this->nextAttempt) >= 0;
+      break;
+  }
+  if (!due || this->isInputPending(now)) return this->state;
+  if (this->state == State::DOWN) this->recover();
+  else this->probe();
+  return this->state;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Wait until the link is up (e.g., in setup), calling update           */
+/* @param timeout                                                       */
+/*          the maximum wait time, in milliseconds (the recovery step   */
+/*          in progress may exceed it)                                  */
+/* @return true if the link is up, false if the timeout occurred        */
+/************************************************************************/
+template <class Transport>
+bool ESP8266LinkT<Transport>::waitUp(uint32_t timeout) {
+  uint32_t start = millis();
+  while (this->update() == State::DOWN)
+    if (millis() - start >= timeout) return false;
+  return true;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Report a successful operation (e.g., SEND OK), which proves that the */
+/* link is up: the next probe is delayed, so a busy link is not probed. */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::reportSuccess() {
+  if (this->state == State::DOWN) return;
+  this->lastProbe = this->lastOk = millis();
+  this->failures = 0;
+  this->state = State::UP;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Report a failed operation (e.g., a send timeout). It counts as a     */
+/* failed probe, so the link is probed again soon, and a second failure */
+/* means the link is down (faster than waiting for the next probe).     */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::reportFailure() {
+  if (this->state == State::DOWN) return;
+  this->lastProbe = millis();
+  this->failed();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Probe the module with the AT command                                 */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::probe() {
+  this->lastProbe = millis();
+  if (this->esp.at(ESP8266_LINK_PROBE_TIMEOUT) == Error::NONE) {
+    this->lastOk = this->lastProbe;
+    this->failures = 0;
+    this->state = State::UP;
+  } else this->failed();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Check if received data is pending, so the probe must wait until the  */
+/* sketch reads it (data not read for ESP8266_LINK_INPUT_WAIT           */
+/* milliseconds is not expected by the sketch, so it can be dropped)    */
+/* @param now                                                           */
+/*          the current time (milliseconds)                             */
+/* @return true if the probe must wait, false otherwise                 */
+/************************************************************************/
+template <class Transport>
+bool ESP8266LinkT<Transport>::isInputPending(uint32_t now) {
+  if (this->esp.available() <= 0) {
+    this->inputPending = false;
+    return false;
+  }
+  if (!this->inputPending) {
+    this->inputPending = true;
+    this->inputSince = now;
+  }
+  return now - this->inputSince < ESP8266_LINK_INPUT_WAIT;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Count a failure, and start the recovery if the link seems down       */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::failed() {
+  if (++this->failures < ESP8266_LINK_PROBE_FAILURES) {
+    this->state = State::SUSPECT;
+    return;
+  }
+  // failed again before being stable: continue with the next level
+  this->down(this->level == Level::NONE ? Level::AT
+    : this->next(this->level));
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Mark the link as down, and schedule the first recovery step          */
+/* @param first                                                         */
+/*          the first ladder level to use                               */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::down(Level first) {
+  uint32_t now = millis();
+  this->state = State::DOWN;
+  this->level = first;
+  this->levelAttempts = 0;
+  this->detectedAt = this->nextAttempt = now;
+  if (this->starting) return;
+  this->detections++;
+  this->lastDetectTime = now - this->lastOk;
+  if (this->lastDetectTime > this->maxDetectTime)
+    this->maxDetectTime = this->lastDetectTime;
+  TRACE(TRACE_EV_LINK_DOWN,
+    this->lastDetectTime > 0xFFFF ? 0xFFFF : this->lastDetectTime);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Mark the link as up, after a successful recovery step                */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::up() {
+  uint32_t now = millis();
+  this->state = State::UP;
+  this->failures = 0;
+  this->lastProbe = this->lastOk = this->upSince = now;
+  if (this->starting) {
+    this->starting = false;
+    this->level = Level::NONE;
+    this->backoffStep = 0;
+    return;
+  }
+  this->recoveries++;
+  this->lastRecoverTime = now - this->detectedAt;
+  this->recoverTimeSum += this->lastRecoverTime;
+  if (this->lastRecoverTime > this->maxRecoverTime)
+    this->maxRecoverTime = this->lastRecoverTime;
+  TRACE(TRACE_EV_LINK_UP,
+    this->lastRecoverTime > 0xFFFF ? 0xFFFF : this->lastRecoverTime);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Run one recovery step at the current level. If it fails, the next    */
+/* step is delayed (exponential backoff with jitter), and the next      */
+/* level is used after ESP8266_LINK_LEVEL_ATTEMPTS attempts.            */
+/************************************************************************/
+template <class Transport>
+void ESP8266LinkT<Transport>::recover() {
+  uint32_t backoff = ESP8266_LINK_MIN_BACKOFF;
+  this->attempts++;
+  TRACE(TRACE_EV_LINK_STEP, (uint8_t)this->level);
+  if (this->restore(this->level) == Error::NONE
+    && this->esp.at(ESP8266_LINK_PROBE_TIMEOUT) == Error::NONE) {
+    this->up();
+    return;
+  }
+  if (++this->levelAttempts >= ESP8266_LINK_LEVEL_ATTEMPTS) {
+    this->level = this->next(this->level);
+    this->levelAttempts = 0;
+  }
+  // the delay is doubled for every failed attempt, up to the maximum,
+  // then a random part is removed, so many nodes do not retry together
+  if (this->backoffStep < 16) backoff <<= this->backoffStep++;
+  else backoff = ESP8266_LINK_MAX_BACKOFF;
+  if (backoff > ESP8266_LINK_MAX_BACKOFF) backoff = ESP8266_LINK_MAX_BACKOFF;
+  backoff -= random(backoff / 2 + 1);
+  this->nextAttempt = millis() + backoff;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Check if a ladder level can be used (it was configured)              */
+/* @param level                                                         */
+/*          the ladder level                                            */
+/* @return true if the level can be used                                */
+/************************************************************************/
+template <class Transport>
+bool ESP8266LinkT<Transport>::isAvailable(Level level) {
+  switch (level) {
+    case Level::RECONNECT: return this->host != 0;
+    case Level::REJOIN: return this->ssid != 0;
+    case Level::HARD_RESET: return this->resetPin >= 0;
+    default: return level != Level::NONE;
+  }
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Get the ladder level used after a level                              */
+/* @param level                                                         */
+/*          the current ladder level                                    */
+/* @return the next configured level, or the current level if it is     */
+/*         the last one                                                 */
+/************************************************************************/
+template <class Transport>
+typename ESP8266LinkT<Transport>::Level ESP8266LinkT<Transport>::next(
+  Level level) {
+  uint8_t l = (uint8_t)level;
+  while (++l <= (uint8_t)Level::HARD_RESET)
+    if (this->isAvailable((Level)l)) return (Level)l;
+  return level;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Run the recovery action of a ladder level. After a reset, the module */
+/* joins the access point and connects to the server again.             */
+/* @param level                                                         */
+/*          the ladder level                                            */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266LinkT<Transport>::restore(Level level) {
+  Error error = Error::NONE;
+  switch (level) {
+    case Level::HARD_RESET:
+      digitalWrite(this->resetPin, LOW);
+      delay(ESP8266_LINK_RESET_PULSE);
+      digitalWrite(this->resetPin, HIGH);
+      // the boot message may be garbled (the boot loader uses another
+      // baud rate), so only wait for it: the final AT probe decides
+      this->esp.waitReady(ESP8266_LINK_BOOT_TIMEOUT);
+      break;
+    case Level::RESET:
+      error = this->esp.atRst();
+      break;
+    case Level::REJOIN:
+      error = this->esp.atCwjap(this->ssid, this->passwd);
+      break;
+    case Level::RECONNECT:
+      // the connection may be already closed, so ignore the error
+      this->esp.atCipclose();
+      break;
+    default:
+      // the AT level: only the final AT probe (see recover)
+      return Error::NONE;
+  }
+  if (error != Error::NONE) return error;
+  if (level >= Level::RESET && this->resetHandler) this->resetHandler();
+  // after a reset, the module joins the last access point by itself
+  // (if it can), but it is faster to not wait for it
+  if (level >= Level::RESET && this->ssid)
+    error = this->esp.atCwjap(this->ssid, this->passwd);
+  if (error != Error::NONE || !this->host) return error;
+  return this->esp.atCipstartTcp(this->host, this->port);
+};
+#endif
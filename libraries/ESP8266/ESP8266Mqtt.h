@@ -0,0 +1,511 @@
+/* 
+ * Minimal MQTT 3.1.1 publisher over the ESP8266 TCP connection
+ * (CONNECT, PUBLISH with QoS 0 or 1, PINGREQ keep alive, reconnect).
+ *
+ * @file ESP8266Mqtt.h
+ * @version 1.0 
+ */ 
+#ifndef __ESP8266_MQTT_H__
+#define __ESP8266_MQTT_H__
+
+#include "ESP8266.h"
+
+// size of the packet buffer: the longest packet (CONNECT or 
+// PUBLISH, including the full topic and the payload) must fit
+#define ESP8266_MQTT_BUFFER_SIZE 96
+// maximum time to wait for CONNACK, PUBACK and PINGRESP (milliseconds)
+#define ESP8266_MQTT_ACK_TIMEOUT 3000
+// reconnect delay: doubled after every failed attempt (milliseconds)
+#define ESP8266_MQTT_MIN_RECONNECT_DELAY 1000
+#define ESP8266_MQTT_MAX_RECONNECT_DELAY 64000
+
+template <class Transport>
+class ESP8266MqttT {
+  public:
+    typedef typename ESP8266T<Transport>::LinkId LinkId;
+    enum class Error {
+      NONE = 0,
+      // TIMEOUT ==> no CONNACK/PUBACK/PINGRESP in time (link is closed)
+      TIMEOUT = 1,
+      // LINK ==> the TCP connection could not be started or used
+      LINK,
+      // REFUSED ==> the broker refused the connection (see getReturnCode)
+      REFUSED,
+      // NOT_CONNECTED ==> waiting for the next reconnect attempt
+      NOT_CONNECTED,
+      // TOO_LONG ==> the packet does not fit in the packet buffer
+      TOO_LONG
+    };
+    enum class QoS: uint8_t {
+      AT_MOST_ONCE = 0,
+      AT_LEAST_ONCE = 1
+    };
+    ESP8266MqttT(ESP8266T<Transport> &esp, const char *clientId, 
+      uint16_t keepAlive = 60);
+    void setBroker(const char *host, uint16_t port = 1883);
+    void setCredentials(const char *user, const char *passwd);
+    /**
+     * Set the topic prefix, e.g., "home/node1/". The published topic is 
+     * the prefix followed by the short suffix given to publish, so the
+     * (long) prefix is not repeated in the sketch memory.
+     */
+    void setTopicPrefix(const char *prefix) { this->prefix = prefix; };
+    Error connect(uint16_t timeout = 10000);
+    void disconnect();
+    bool isConnected() { return this->connected; };
+    Error publish(const char *topic, const uint8_t *payload, uint16_t len, 
+      QoS qos = QoS::AT_MOST_ONCE, bool retain = false);
+    inline Error publish(const char *topic, const char *payload, 
+      QoS qos = QoS::AT_MOST_ONCE, bool retain = false) {
+      return this->publish(topic, (const uint8_t*)payload, 
+        strlen(payload), qos, retain);
+    };
+    Error update();
+    // the CONNACK return code (0 means accepted)
+    uint8_t getReturnCode() { return this->returnCode; };
+    // statistics
+    uint32_t getPublished() { return this->published; };
+    uint32_t getAcked() { return this->acked; };
+    // the received packets (any type), e.g., to report the traffic to ESP8266Link
+    uint32_t getPackets() { return this->packets; };
+    uint32_t getBytesSent() { return this->bytesSent; };
+    uint16_t getReconnects() { return this->reconnects; };
+    // PUBLISH to PUBACK latency, in milliseconds
+    uint16_t getLastLatency() { return this->lastLatency; };
+    uint16_t getMaxLatency() { return this->maxLatency; };
+  private:
+    ESP8266T<Transport> &esp;
+    const char *clientId;
+    const char *user;
+    const char *passwd;
+    const char *host;
+    const char *prefix;
+    uint16_t port;
+    uint16_t keepAlive;
+    bool connected;
+    uint8_t buffer[ESP8266_MQTT_BUFFER_SIZE];
+    uint16_t packetId;
+    // the packets received since the last check (bit n is 
+    // set for packet type n) and their data
+    uint16_t received;
+    uint16_t ackId;
+    uint8_t returnCode;
+    bool pingPending;
+    uint32_t lastSent;
+    uint32_t pingTime;
+    uint32_t lastAttempt;
+    uint32_t reconnectDelay;
+    // statistics
+    uint32_t published;
+    uint32_t acked;
+    uint32_t packets;
+    uint32_t bytesSent;
+    uint16_t reconnects;
+    uint16_t lastLatency;
+    uint16_t maxLatency;
+    Error send(uint16_t len);
+    bool receive(uint8_t type, uint16_t timeout);
+    void readFrame(uint16_t dataLen);
+    uint16_t putHeader(uint8_t type, uint16_t remainingLen);
+    uint16_t putString(uint16_t pos, const char *str);
+};
+// MQTT control packet types
+#define ESP8266_MQTT_CONNECT 1
+#define ESP8266_MQTT_CONNACK 2
+#define ESP8266_MQTT_PUBLISH 3
+#define ESP8266_MQTT_PUBACK 4
+#define ESP8266_MQTT_PINGREQ 12
+#define ESP8266_MQTT_PINGRESP 13
+#define ESP8266_MQTT_DISCONNECT 14
+// constants stored in Program Memory (FLASH)
+const char ESP8266_MQTT_PGM_PROTOCOL[] PROGMEM = "MQTT";
+// the MQTT client for the ESP8266 driver for any Stream
+typedef ESP8266MqttT<Stream> ESP8266Mqtt;
+
+/************************************************************************/
+/* @constructor                                                         */
+/* @param esp                                                           */
+/*          the ESP8266 module (single connection mode, CIPMUX = 0)     */
+/* @param clientId                                                      */
+/*          the MQTT client identifier (unique for the broker)          */
+/* @param keepAlive                                                     */
+/*          the keep alive interval, in seconds                         */
+/*          NOTE: default value is 60                                   */
+/************************************************************************/
+template <class Transport>
+ESP8266MqttT<Transport>::ESP8266MqttT(
+  ESP8266T<Transport> &esp, const char *clientId,
+  uint16_t keepAlive): esp(esp) {
+  this->clientId = clientId;
+  this->user = 0;
+  this->passwd = 0;
+  this->host = 0;
+  this->prefix = "";
+  this->port = 1883;
+  this->keepAlive = keepAlive;
+  this->connected = false;
+  this->packetId = 0;
+  this->received = 0;
+  this->ackId = 0;
+  this->returnCode = 0;
+  this->pingPending = false;
+  this->lastSent = 0;
+  this->pingTime = 0;
+  this->lastAttempt = 0;
+  this->reconnectDelay = ESP8266_MQTT_MIN_RECONNECT_DELAY;
+  this->published = 0;
+  this->acked = 0;
+  this->packets = 0;
+  this->bytesSent = 0;
+  this->reconnects = 0;
+  this->lastLatency = 0;
+  this->maxLatency = 0;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the broker address                                               */
+/* @param host                                                          */
+/*          the IP or the domain name of the broker                     */
+/* @param port                                                          */
+/*          the broker port                                             */
+/*          NOTE: default value is 1883                                 */
+/************************************************************************/
+template <class Transport>
+void ESP8266MqttT<Transport>::setBroker(const char *host, uint16_t port) {
+  this->host = host;
+  this->port = port;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the user name and password used to connect to the broker         */
+/* @param user                                                          */
+/*          the user name (0 if not required)                           */
+/* @param passwd                                                        */
+/*          the password (0 if not required)                            */
+/************************************************************************/
+template <class Transport>
+void ESP8266MqttT<Transport>::setCredentials(
+  const char *user, const char *passwd) {
+  this->user = user;
+  this->passwd = passwd;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Open the TCP connection to the broker and send CONNECT (clean        */
+/* session), then wait for CONNACK                                      */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for the TCP connection      */
+/*          NOTE: default value is 10000                                */
+/* @return ESP8266Mqtt::Error::NONE if connected, the error otherwise   */
+/************************************************************************/
+template <class Transport>
+typename ESP8266MqttT<Transport>::Error ESP8266MqttT<Transport>::connect(
+  uint16_t timeout) {
+  Error error = Error::NONE;
+  uint16_t len = 10 + 2 + strlen(this->clientId), pos = 0;
+  uint8_t flags = 0x02;
+  this->connected = false;
+  this->pingPending = false;
+  if (this->user) {
+    flags |= 0x80;
+    len += 2 + strlen(this->user);
+  }
+  if (this->passwd) {
+    flags |= 0x40;
+    len += 2 + strlen(this->passwd);
+  }
+  // the header is at most 3 bytes long
+  if (len + 3 > ESP8266_MQTT_BUFFER_SIZE) return Error::TOO_LONG;
+  // close a (possible) previous connection, then connect again
+  this->esp.atCipclose();
+  if (this->esp.atCipstartTcp(this->host, this->port, timeout) 
+    != ATTransportBase::Error::NONE) return Error::LINK;
+  // fixed header and variable header: protocol 
+  // name, level (4 means 3.1.1), flags and keep alive
+  pos = this->putHeader(ESP8266_MQTT_CONNECT << 4, len);
+  this->buffer[pos++] = 0;
+  this->buffer[pos++] = 4;
+  memcpy_P(this->buffer + pos, ESP8266_MQTT_PGM_PROTOCOL, 4);
+  pos += 4;
+  this->buffer[pos++] = 4;
+  this->buffer[pos++] = flags;
+  this->buffer[pos++] = this->keepAlive >> 8;
+  this->buffer[pos++] = this->keepAlive & 0xFF;
+  // payload
+  pos = this->putString(pos, this->clientId);
+  if (this->user) pos = this->putString(pos, this->user);
+  if (this->passwd) pos = this->putString(pos, this->passwd);
+  this->received = 0;
+  if ((error = this->send(pos)) != Error::NONE) return error;
+  if (!this->receive(ESP8266_MQTT_CONNACK, ESP8266_MQTT_ACK_TIMEOUT)) {
+    this->esp.atCipclose();
+    return Error::TIMEOUT;
+  }
+  if (this->returnCode != 0) {
+    this->esp.atCipclose();
+    return Error::REFUSED;
+  }
+  this->connected = true;
+  this->reconnectDelay = ESP8266_MQTT_MIN_RECONNECT_DELAY;
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send DISCONNECT and close the TCP connection                         */
+/************************************************************************/
+template <class Transport>
+void ESP8266MqttT<Transport>::disconnect() {
+  uint16_t pos = 0;
+  if (this->connected) {
+    pos = this->putHeader(ESP8266_MQTT_DISCONNECT << 4, 0);
+    this->send(pos);
+  }
+  this->connected = false;
+  this->esp.atCipclose();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Publish a message. With QoS 1, wait for PUBACK (blocking): if it     */
+/* does not come, the connection is considered lost, so the message     */
+/* should be kept (e.g., in an EepromQueue) and published again later.  */
+/* @param topic                                                         */
+/*          the topic suffix, added to the topic prefix                 */
+/* @param payload                                                       */
+/*          the message data (may contain any byte value)               */
+/* @param len                                                           */
+/*          the message data length                                     */
+/* @param qos                                                           */
+/*          the quality of service (0 or 1)                             */
+/*          NOTE: default value is QoS::AT_MOST_ONCE                    */
+/* @param retain                                                        */
+/*          true if the broker must retain the message                  */
+/*          NOTE: default value is false                                */
+/* @return ESP8266Mqtt::Error::NONE if all OK, the error otherwise      */
+/************************************************************************/
+template <class Transport>
+typename ESP8266MqttT<Transport>::Error ESP8266MqttT<Transport>::publish(
+  const char *topic, const uint8_t *payload, uint16_t len, QoS qos,
+  bool retain) {
+  Error error = Error::NONE;
+  uint16_t prefixLen = strlen(this->prefix), topicLen = strlen(topic);
+  uint16_t remainingLen = 2 + prefixLen + topicLen + len, pos = 0;
+  uint32_t start = 0;
+  long remaining = 0;
+  if (!this->connected) return Error::NOT_CONNECTED;
+  if (qos == QoS::AT_LEAST_ONCE) remainingLen += 2;
+  if (remainingLen + 3 > ESP8266_MQTT_BUFFER_SIZE) return Error::TOO_LONG;
+  pos = this->putHeader((ESP8266_MQTT_PUBLISH << 4) | ((uint8_t)qos << 1) 
+    | (retain ? 1 : 0), remainingLen);
+  // the topic is the prefix followed by the suffix
+  this->buffer[pos++] = (prefixLen + topicLen) >> 8;
+  this->buffer[pos++] = (prefixLen + topicLen) & 0xFF;
+  memcpy(this->buffer + pos, this->prefix, prefixLen);
+  pos += prefixLen;
+  memcpy(this->buffer + pos, topic, topicLen);
+  pos += topicLen;
+  if (qos == QoS::AT_LEAST_ONCE) {
+    // packet identifiers must be non-zero
+    if (++this->packetId == 0) this->packetId = 1;
+    this->buffer[pos++] = this->packetId >> 8;
+    this->buffer[pos++] = this->packetId & 0xFF;
+  }
+  memcpy(this->buffer + pos, payload, len);
+  pos += len;
+  start = millis();
+  this->received &= ~(1 << ESP8266_MQTT_PUBACK);
+  if ((error = this->send(pos)) != Error::NONE) return error;
+  this->published++;
+  if (qos == QoS::AT_MOST_ONCE) return Error::NONE;
+  while ((remaining = ESP8266_MQTT_ACK_TIMEOUT - (long)(millis() - start)) > 0
+    && this->receive(ESP8266_MQTT_PUBACK, remaining)) {
+    // a late PUBACK, of a previous message, is ignored
+    if (this->ackId != this->packetId) continue;
+    this->acked++;
+    this->lastLatency = millis() - start;
+    if (this->lastLatency > this->maxLatency) 
+      this->maxLatency = this->lastLatency;
+    return Error::NONE;
+  }
+  this->connected = false;
+  return Error::TIMEOUT;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Keep the connection alive (call it from loop): read the broker       */
+/* packets, send PINGREQ when no packet was sent for 3/4 of the keep    */
+/* alive interval, and reconnect (with exponential backoff) when the    */
+/* connection was lost.                                                 */
+/* @return ESP8266Mqtt::Error::NONE if connected, the error otherwise   */
+/************************************************************************/
+template <class Transport>
+typename ESP8266MqttT<Transport>::Error ESP8266MqttT<Transport>::update() {
+  Error error = Error::NONE;
+  LinkId linkId = LinkId::NONE;
+  uint16_t dataLen = 0, pos = 0;
+  if (!this->connected) {
+    if (millis() - this->lastAttempt < this->reconnectDelay) 
+      return Error::NOT_CONNECTED;
+    this->lastAttempt = millis();
+    error = this->connect();
+    if (error != Error::NONE) {
+      if (this->reconnectDelay < ESP8266_MQTT_MAX_RECONNECT_DELAY) 
+        this->reconnectDelay *= 2;
+      return error;
+    }
+    this->reconnects++;
+    return Error::NONE;
+  }
+  // read the pending broker packets (e.g., PINGRESP)
+  do {
+    if (this->esp.ipdHeader(dataLen, linkId) 
+      != ATTransportBase::Error::NONE) break;
+    if (dataLen > 0) this->readFrame(dataLen);
+  } while (dataLen > 0);
+  if (this->pingPending) {
+    if (this->received & (1 << ESP8266_MQTT_PINGRESP)) 
+      this->pingPending = false;
+    else if (millis() - this->pingTime > ESP8266_MQTT_ACK_TIMEOUT) {
+      this->connected = false;
+      return Error::TIMEOUT;
+    }
+  } else if (this->keepAlive > 0 
+    && millis() - this->lastSent >= this->keepAlive * 750UL) {
+    pos = this->putHeader(ESP8266_MQTT_PINGREQ << 4, 0);
+    this->received &= ~(1 << ESP8266_MQTT_PINGRESP);
+    if ((error = this->send(pos)) != Error::NONE) return error;
+    this->pingPending = true;
+    this->pingTime = millis();
+  }
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send the packet stored in the packet buffer                          */
+/* @param len                                                           */
+/*          the packet length                                           */
+/* @return ESP8266Mqtt::Error::NONE if all OK, Error::LINK otherwise    */
+/************************************************************************/
+template <class Transport>
+typename ESP8266MqttT<Transport>::Error ESP8266MqttT<Transport>::send(
+  uint16_t len) {
+  if (this->esp.atCipsend(this->buffer, len) != ATTransportBase::Error::NONE) {
+    this->connected = false;
+    return Error::LINK;
+  }
+  this->bytesSent += len;
+  this->lastSent = millis();
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Wait for a packet from the broker (blocking)                         */
+/* @param type                                                          */
+/*          the packet type (e.g., ESP8266_MQTT_PUBACK)                 */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for the packet              */
+/* @return true if the packet was received, false otherwise             */
+/************************************************************************/
+template <class Transport>
+bool ESP8266MqttT<Transport>::receive(uint8_t type, uint16_t timeout) {
+  LinkId linkId = LinkId::NONE;
+  uint16_t dataLen = 0;
+  uint32_t start = millis();
+  do {
+    if (this->received & (1 << type)) {
+      this->received &= ~(1 << type);
+      return true;
+    }
+    this->esp.ipdHeader(dataLen, linkId);
+    if (dataLen > 0) this->readFrame(dataLen);
+  } while (millis() - start < timeout);
+  return false;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Read the packets of a received frame (see ESP8266::ipdHeader). Only  */
+/* the first two bytes after the fixed header are stored, which is all  */
+/* needed by the CONNACK, PUBACK and PINGRESP packets.                  */
+/* @param dataLen                                                       */
+/*          the frame data length                                       */
+/************************************************************************/
+template <class Transport>
+void ESP8266MqttT<Transport>::readFrame(uint16_t dataLen) {
+  uint8_t type = 0, shift = 0, data[2] = {0};
+  uint16_t remainingLen = 0, i = 0;
+  int c = 0;
+  while (dataLen > 0) {
+    // fixed header: type and remaining length
+    if ((c = this->esp.ipdRead()) < 0) return;
+    dataLen--;
+    type = c >> 4;
+    remainingLen = 0;
+    shift = 0;
+    do {
+      if ((c = this->esp.ipdRead()) < 0) return;
+      dataLen--;
+      remainingLen |= (c & 0x7F) << shift;
+      shift += 7;
+    } while ((c & 0x80) && dataLen > 0);
+    for (i = 0; i < remainingLen && dataLen > 0; i++, dataLen--) {
+      if ((c = this->esp.ipdRead()) < 0) return;
+      if (i < 2) data[i] = c;
+    }
+    if (type == ESP8266_MQTT_CONNACK) this->returnCode = data[1];
+    else if (type == ESP8266_MQTT_PUBACK) 
+      this->ackId = (data[0] << 8) | data[1];
+    this->received |= 1 << type;
+    this->packets++;
+  }
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Write the fixed header in the packet buffer                          */
+/* @param type                                                          */
+/*          the first header byte (packet type and flags)               */
+/* @param remainingLen                                                  */
+/*          the packet length, without the fixed header                 */
+/* @return the fixed header length                                      */
+/************************************************************************/
+template <class Transport>
+uint16_t ESP8266MqttT<Transport>::putHeader(
+  uint8_t type, uint16_t remainingLen) {
+  uint16_t pos = 0;
+  this->buffer[pos++] = type;
+  // variable length encoding, 7 bits per byte
+  do {
+    this->buffer[pos] = remainingLen & 0x7F;
+    remainingLen >>= 7;
+    if (remainingLen > 0) this->buffer[pos] |= 0x80;
+    pos++;
+  } while (remainingLen > 0);
+  return pos;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Write a string (16 bits length, then the chars) in the packet buffer */
+/* @param pos                                                           */
+/*          the position in the packet buffer                           */
+/* @param str                                                           */
+/*          the string                                                  */
+/* @return the position after the string                                */
+/************************************************************************/
+template <class Transport>
+uint16_t ESP8266MqttT<Transport>::putString(uint16_t pos, const char *str) {
+  uint16_t len = strlen(str);
+  this->buffer[pos++] = len >> 8;
+  this->buffer[pos++] = len & 0xFF;
+  memcpy(this->buffer + pos, str, len);
+  return pos + len;
+};
+#endif
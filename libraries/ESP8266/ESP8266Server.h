@@ -0,0 +1,419 @@
+/* 
+ * Lightweight TCP server (AT+CIPSERVER) answering HTTP GET and
+ * line protocol requests with the latest sensor readings.
+ *
+ * @file ESP8266Server.h
+ * @version 1.0 
+ */ 
+#ifndef __ESP8266_SERVER_H__
+#define __ESP8266_SERVER_H__
+
+#include "ESP8266.h"
+
+// maximum number of published values
+#define ESP8266_SERVER_MAX_VALUES 8
+// size of the response cache: HTTP header plus the
+// "name=value\r\n" lines of all the values
+#define ESP8266_SERVER_CACHE_SIZE 192
+// space reserved in the cache for the HTTP header
+#define ESP8266_SERVER_HEADER_SIZE 88
+// only the first request line is stored (and used)
+#define ESP8266_SERVER_REQUEST_SIZE 24
+// the ESP8266 accepts up to 5 clients (link IDs 0 to 4)
+#define ESP8266_SERVER_MAX_CLIENTS 5
+
+template <class Transport>
+class ESP8266ServerT {
+  public:
+    typedef ATTransportBase::Error Error;
+    typedef typename ESP8266T<Transport>::LinkId LinkId;
+    enum class Request: uint8_t {
+      // HTTP GET / ==> HTTP response with all the values
+      HTTP_GET = 0,
+      // HTTP GET for any other path ==> 404 Not Found
+      HTTP_NOT_FOUND = 1,
+      // READ line ==> all the values, no header
+      LINE = 2,
+      // anything else ==> ERR line
+      UNKNOWN = 3
+    };
+    ESP8266ServerT(ESP8266T<Transport> &esp);
+    Error begin(uint16_t port = 80, uint16_t clientTimeout = 10);
+    Error end();
+    char add(const char *name, uint8_t decimals = 0);
+    void set(uint8_t index, int32_t value);
+    Error update(uint16_t waitTime = 0);
+    // statistics
+    uint32_t getRequests() { return this->requests; };
+    uint32_t getResponses() { return this->responses; };
+    uint32_t getErrors() { return this->errors; };
+    uint32_t getRenders() { return this->renders; };
+    uint32_t getClientRequests(uint8_t linkId) { 
+      return this->clientRequests[linkId]; 
+    };
+    // response latency, in milliseconds (from request to SEND OK)
+    uint16_t getMaxLatency() { return this->maxLatency; };
+    uint16_t getMeanLatency() { 
+      return this->responses ? this->latencySum / this->responses : 0; 
+    };
+    // responses per second, updated every second
+    uint16_t getThroughput() { return this->throughput; };
+  private:
+    // A published value: a fixed point number with 
+    // the given number of decimals (e.g., 2150 and 2 is 21.50)
+    struct Value {
+      const char *name = 0;
+      int32_t value = 0;
+      uint8_t decimals = 0;
+    };
+    ESP8266T<Transport> &esp;
+    Value values[ESP8266_SERVER_MAX_VALUES];
+    uint8_t count;
+    // the cache needs to be rendered again (a value changed)
+    bool dirty;
+    // the HTTP header is rendered right before the body, so the HTTP
+    // response starts at headerStart and the line response (the body 
+    // only) starts at ESP8266_SERVER_HEADER_SIZE
+    char cache[ESP8266_SERVER_CACHE_SIZE];
+    uint16_t headerStart;
+    uint16_t bodyLen;
+    char request[ESP8266_SERVER_REQUEST_SIZE];
+    // statistics
+    uint32_t requests;
+    uint32_t responses;
+    uint32_t errors;
+    uint32_t renders;
+    uint32_t clientRequests[ESP8266_SERVER_MAX_CLIENTS];
+    uint32_t latencySum;
+    uint16_t maxLatency;
+    uint16_t throughput;
+    uint16_t rateResponses;
+    uint32_t rateStart;
+    void render();
+    uint8_t renderValue(char *buffer, const Value &value);
+    Request readRequest(uint16_t dataLen);
+    Error respond(LinkId linkId, Request request);
+    Error respondPM(LinkId linkId, const char pmData[]);
+};
+// constants stored in Program Memory (FLASH)
+const char ESP8266_SERVER_PGM_HTTP_GET_ROOT[] PROGMEM = "GET / ";
+const char ESP8266_SERVER_PGM_HTTP_GET[] PROGMEM = "GET ";
+const char ESP8266_SERVER_PGM_LINE_READ[] PROGMEM = "READ";
+const char ESP8266_SERVER_PGM_HTTP_200[] PROGMEM = 
+  "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: ";
+const char ESP8266_SERVER_PGM_HTTP_HEADERS_END[] PROGMEM = 
+  "\r\nConnection: close\r\n\r\n";
+const char ESP8266_SERVER_PGM_HTTP_404[] PROGMEM = 
+  "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+const char ESP8266_SERVER_PGM_LINE_ERR[] PROGMEM = "ERR\r\n";
+// the server for the ESP8266 driver for any Stream
+typedef ESP8266ServerT<Stream> ESP8266Server;
+
+/************************************************************************/
+/* @constructor                                                         */
+/* @param esp                                                           */
+/*          the ESP8266 module used by the server                       */
+/************************************************************************/
+template <class Transport>
+ESP8266ServerT<Transport>::ESP8266ServerT(ESP8266T<Transport> &esp): esp(esp) {
+  this->count = 0;
+  this->dirty = true;
+  this->headerStart = ESP8266_SERVER_HEADER_SIZE;
+  this->bodyLen = 0;
+  this->requests = 0;
+  this->responses = 0;
+  this->errors = 0;
+  this->renders = 0;
+  for (uint8_t i = 0; i < ESP8266_SERVER_MAX_CLIENTS; i++)
+    this->clientRequests[i] = 0;
+  this->latencySum = 0;
+  this->maxLatency = 0;
+  this->throughput = 0;
+  this->rateResponses = 0;
+  this->rateStart = 0;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Start the server: enable multiple connections (AT+CIPMUX=1), start   */
+/* the TCP server (AT+CIPSERVER) and set the idle client timeout        */
+/* (AT+CIPSTO). The ESP8266 module accepts up to 5 clients.             */
+/* @param port                                                          */
+/*          the server port                                             */
+/*          NOTE: default value is 80                                   */
+/* @param clientTimeout                                                 */
+/*          idle clients are disconnected after this time (seconds)     */
+/*          NOTE: default value is 10                                   */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266ServerT<Transport>::begin(
+  uint16_t port, uint16_t clientTimeout) {
+  Error error = Error::NONE;
+  error = this->esp.atCipmux(true);
+  if (error != Error::NONE) return error;
+  error = this->esp.atCipserver(true, port);
+  if (error != Error::NONE) return error;
+  this->rateStart = millis();
+  return this->esp.atCipsto(clientTimeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Stop the server (AT+CIPSERVER=0)                                     */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266ServerT<Transport>::end() {
+  return this->esp.atCipserver(false);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Add a published value, e.g., add("t", 2) for a temperature given in  */
+/* hundredths of degree. Values are published in the order were added.  */
+/* @param name                                                          */
+/*          the value name (the string is not copied, so it must exist  */
+/*          as long as the server is used)                              */
+/* @param decimals                                                      */
+/*          number of decimals of the fixed point value                 */
+/*          NOTE: default value is 0                                    */
+/* @return the value index, used to set the value,                      */
+/*         or -1 if no more values can be added                         */
+/************************************************************************/
+template <class Transport>
+char ESP8266ServerT<Transport>::add(const char *name, uint8_t decimals) {
+  if (this->count >= ESP8266_SERVER_MAX_VALUES) return -1;
+  this->values[this->count].name = name;
+  this->values[this->count].decimals = decimals;
+  this->dirty = true;
+  return this->count++;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set a published value. The response cache is rendered again only if  */
+/* the value changed, and only when the next request is answered.       */
+/* @param index                                                         */
+/*          the value index (as returned by ESP8266Server::add)         */
+/* @param value                                                         */
+/*          the fixed point value (see ESP8266Server::add)              */
+/************************************************************************/
+template <class Transport>
+void ESP8266ServerT<Transport>::set(uint8_t index, int32_t value) {
+  if (index >= this->count || this->values[index].value == value) return;
+  this->values[index].value = value;
+  this->dirty = true;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Answer one client request, if any (call it from loop):               */
+/*   - "GET / HTTP/1.x" ==> the values, as text/plain HTTP response     */
+/*   - "GET /other HTTP/1.x" ==> 404 Not Found                          */
+/*   - "READ" line ==> the values (the connection stays open)           */
+/*   - any other line ==> "ERR"                                         */
+/* Each value is a "name=value\r\n" line. HTTP connections are closed   */
+/* after the response.                                                  */
+/* @param waitTime                                                      */
+/*          timeout in milliseconds to wait for a request (blocking!)   */
+/*          NOTE: default value is 0                                    */
+/* @return ESP8266::Error_NONE if all OK (including the case when no    */
+/*         request was received), ESP8266::Error::XXX otherwise         */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266ServerT<Transport>::update(uint16_t waitTime) {
+  Error error = Error::NONE;
+  LinkId linkId = LinkId::NONE;
+  uint16_t dataLen = 0, latency = 0;
+  uint32_t start = 0;
+  Request request = Request::UNKNOWN;
+  // update the throughput, once per second
+  if (millis() - this->rateStart >= 1000) {
+    this->throughput = this->rateResponses;
+    this->rateResponses = 0;
+    this->rateStart = millis();
+  }
+  error = this->esp.ipdHeader(dataLen, linkId, waitTime);
+  if (error != Error::NONE) {
+    this->errors++;
+    return error;
+  }
+  // no request
+  if (dataLen == 0) return Error::NONE;
+  start = millis();
+  this->requests++;
+  if (linkId < LinkId::ALL) this->clientRequests[(uint8_t)linkId]++;
+  request = this->readRequest(dataLen);
+  error = this->respond(linkId, request);
+  if (error != Error::NONE) {
+    this->errors++;
+    return error;
+  }
+  latency = millis() - start;
+  this->responses++;
+  this->rateResponses++;
+  this->latencySum += latency;
+  if (latency > this->maxLatency) this->maxLatency = latency;
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Read the request data: the first line is stored, the rest of the     */
+/* data (e.g., the HTTP headers) is dropped.                            */
+/* @param dataLen                                                       */
+/*          the request data length (see ESP8266::ipdHeader)            */
+/* @return the request type (see ESP8266Server::Request::xxx)           */
+/************************************************************************/
+template <class Transport>
+typename ESP8266ServerT<Transport>::Request 
+ESP8266ServerT<Transport>::readRequest(uint16_t dataLen) {
+  uint8_t len = 0;
+  bool lineEnd = false;
+  int c = 0;
+  for (uint16_t i = 0; i < dataLen; i++) {
+    if ((c = this->esp.ipdRead()) < 0) break;
+    if (c == '\r' || c == '\n') lineEnd = true;
+    if (!lineEnd && len < ESP8266_SERVER_REQUEST_SIZE - 1) 
+      this->request[len++] = c;
+  }
+  this->request[len] = '\0';
+  if (strncmp_P(this->request, ESP8266_SERVER_PGM_HTTP_GET_ROOT, 
+    strlen_P(ESP8266_SERVER_PGM_HTTP_GET_ROOT)) == 0) 
+    return Request::HTTP_GET;
+  if (strncmp_P(this->request, ESP8266_SERVER_PGM_HTTP_GET, 
+    strlen_P(ESP8266_SERVER_PGM_HTTP_GET)) == 0) 
+    return Request::HTTP_NOT_FOUND;
+  if (strcmp_P(this->request, ESP8266_SERVER_PGM_LINE_READ) == 0) 
+    return Request::LINE;
+  return Request::UNKNOWN;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send the response for a request, from the response cache             */
+/* @param linkId                                                        */
+/*          the connection ID of the client                             */
+/* @param request                                                       */
+/*          the request type (see ESP8266Server::Request::xxx)          */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266ServerT<Transport>::respond(LinkId linkId, 
+  Request request) {
+  Error error = Error::NONE;
+  if (request == Request::HTTP_NOT_FOUND) {
+    error = this->respondPM(linkId, ESP8266_SERVER_PGM_HTTP_404);
+    this->esp.atCipclose(linkId);
+    return error;
+  }
+  if (request == Request::UNKNOWN) 
+    return this->respondPM(linkId, ESP8266_SERVER_PGM_LINE_ERR);
+  // render the cache only if a value changed since the last request
+  if (this->dirty) this->render();
+  // no values: nothing to send (AT+CIPSEND needs at least one byte)
+  if (request == Request::LINE && this->bodyLen == 0) return Error::NONE;
+  if (request == Request::LINE)
+    return this->esp.atCipsend(
+      (const uint8_t*)(this->cache + ESP8266_SERVER_HEADER_SIZE), 
+      this->bodyLen, linkId);
+  error = this->esp.atCipsend(
+    (const uint8_t*)(this->cache + this->headerStart), 
+    ESP8266_SERVER_HEADER_SIZE - this->headerStart + this->bodyLen, linkId);
+  this->esp.atCipclose(linkId);
+  return error;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send a constant response, stored in PROGMEM                          */
+/* @param linkId                                                        */
+/*          the connection ID of the client                             */
+/* @param pmData                                                        */
+/*          the response (at most as long as the 404 response)          */
+/* @return ESP8266::Error_NONE if all OK, ESP8266::Error::XXX otherwise */
+/************************************************************************/
+template <class Transport>
+ATTransportBase::Error ESP8266ServerT<Transport>::respondPM(LinkId linkId, 
+  const char pmData[]) {
+  char buffer[sizeof(ESP8266_SERVER_PGM_HTTP_404)];
+  strncpy_P(buffer, pmData, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  return this->esp.atCipsend((const uint8_t*)buffer, strlen(buffer), linkId);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Render the response cache: the body ("name=value\r\n" lines), then   */
+/* the HTTP header right before it (it depends on the body length).     */
+/* The values which don't fit in the cache are not published.           */
+/************************************************************************/
+template <class Transport>
+void ESP8266ServerT<Transport>::render() {
+  char *body = this->cache + ESP8266_SERVER_HEADER_SIZE, *header = 0;
+  char line[32];
+  uint8_t len = 0, nameLen = 0, digits = 0;
+  uint16_t i = 0, bodyLen = 0, headerLen = 0;
+  for (i = 0; i < this->count; i++) {
+    nameLen = strlen(this->values[i].name);
+    if (nameLen > sizeof(line) - 16) continue;
+    memcpy(line, this->values[i].name, nameLen);
+    len = nameLen;
+    line[len++] = '=';
+    len += this->renderValue(line + len, this->values[i]);
+    line[len++] = '\r';
+    line[len++] = '\n';
+    if (bodyLen + len > ESP8266_SERVER_CACHE_SIZE - ESP8266_SERVER_HEADER_SIZE) 
+      break;
+    memcpy(body + bodyLen, line, len);
+    bodyLen += len;
+  }
+  this->bodyLen = bodyLen;
+  // the number of digits of the Content-Length value
+  digits = getDigitsCount(bodyLen);
+  headerLen = strlen_P(ESP8266_SERVER_PGM_HTTP_200) + digits
+    + strlen_P(ESP8266_SERVER_PGM_HTTP_HEADERS_END);
+  this->headerStart = ESP8266_SERVER_HEADER_SIZE - headerLen;
+  header = this->cache + this->headerStart;
+  strcpy_P(header, ESP8266_SERVER_PGM_HTTP_200);
+  header += strlen_P(ESP8266_SERVER_PGM_HTTP_200);
+  for (i = bodyLen, len = digits; len > 0; len--, i /= 10) 
+    header[len - 1] = '0' + i % 10;
+  header += digits;
+  // memcpy_P: the string terminator must not overwrite the body
+  memcpy_P(header, ESP8266_SERVER_PGM_HTTP_HEADERS_END, 
+    strlen_P(ESP8266_SERVER_PGM_HTTP_HEADERS_END));
+  this->dirty = false;
+  this->renders++;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Render a fixed point value, e.g., -5 with 2 decimals is "-0.05"      */
+/* @param buffer                                                        */
+/*          where to render the value (at least 13 chars)               */
+/* @param value                                                         */
+/*          the value to render                                         */
+/* @return the number of rendered chars                                 */
+/************************************************************************/
+template <class Transport>
+uint8_t ESP8266ServerT<Transport>::renderValue(
+  char *buffer, const Value &value) {
+  char digits[11];
+  uint8_t n = 0, len = 0, decimals = value.decimals;
+  uint32_t v = value.value < 0 ? -(uint32_t)value.value : value.value;
+  if (decimals > 9) decimals = 9;
+  // digits, in reverse order, at least one before the decimal point
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v > 0 || n < decimals + 1);
+  if (value.value < 0) buffer[len++] = '-';
+  while (n > 0) {
+    if (n == decimals) buffer[len++] = '.';
+    buffer[len++] = digits[--n];
+  }
+  return len;
+};
+#endif
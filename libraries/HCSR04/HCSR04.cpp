@@ -1,47 +1,104 @@
 #include "HCSR04.h"
 
+HCSR04* HCSR04::isrInstances[2] = {0, 0};
+
 /**
  * Constructor.
  * @param triggerPin
  *          the Arduino pin connected to the trigger pin of the sensor.
  * @param echoPin
  *          the Arduino pin connected to the echo pin of the sensor.
+ * @param maxRange
+ *          the maximum measured distance, in centimeters. Echoes
+ *          longer than this are reported as "out of range".
  */
-HCSR04::HCSR04(unsigned char triggerPin, unsigned char echoPin) {
+HCSR04::HCSR04(unsigned char triggerPin, unsigned char echoPin,
+  unsigned int maxRange) {
   // store the pin used to trigger sensor reading
   this->triggerPin = triggerPin;
   // store the pin used to read data from sensor
   this->echoPin = echoPin;
-  // the trigger pin is set to OUTPUT - is used to inquire data 
+  // compute the echo timeout for the maximum range
+  this->setMaxRange(maxRange);
+  // no asynchronous measurement was started yet
+  this->echoState = EchoEL::IDLE;
+  this->status = StatusEL::NONE;
+  this->echoDuration = 0;
+  this->interruptAttached = false;
+  this->mmPerUs = HCSR04_MM_PER_US_Q16;
+  // the trigger pin is set to OUTPUT - is used to inquire data
   // from sensor by sending a 10uS pulse to the trigger sensor pin
   pinMode(triggerPin, OUTPUT);
   // by default the trigger pin should be LOW
   digitalWrite(triggerPin, LOW);
   // the echo pin is used to capture data, so it is an INPUT
   pinMode(echoPin, INPUT);
-}; 
+};
 
 /**
- * Reads sensor data. 
- * @param unit
- *        measurement unit, value of HCSR04::MetricsEL
- * @return distance in provided measurement unit, 
- *         or -1 if error occured
+ * Destructor: the echo pin interrupt (if attached by trigger) is
+ * detached, so the interrupt routine never uses a destroyed instance.
  */
-float HCSR04::read(HCSR04::MetricsEL unit) {
-  float d = 0;
-  // The sensor requires a 10uS HIGH pulse 
+HCSR04::~HCSR04() {
+  for (unsigned char i = 0; i < 2; i++) {
+    if (HCSR04::isrInstances[i] == this) {
+      detachInterrupt(i);
+      HCSR04::isrInstances[i] = 0;
+    }
+  }
+};
+
+/**
+ * Set the maximum measured distance. This bounds the time waited
+ * for an echo, e.g., 400cm (the default) means about 23ms.
+ * @param maxRange
+ *          the maximum distance, in centimeters; values above
+ *          HCSR04_MAX_RANGE (40m) are reduced to HCSR04_MAX_RANGE.
+ */
+void HCSR04::setMaxRange(unsigned int maxRange) {
+  if (maxRange > HCSR04_MAX_RANGE) maxRange = HCSR04_MAX_RANGE;
+  // the sound needs 58.2uS to travel forth and back 1cm
+  this->echoTimeout = (unsigned long)maxRange * 582 / 10;
+};
+
+/**
+ * Set the air temperature, used to compensate the speed of sound
+ * for the integer methods (readEcho, readMm, readInt, integer poll).
+ * The speed of sound is 331.3 + 0.606 * temperature (m/s).
+ * @param temperature
+ *          the air temperature, in tenths of Celsius degrees
+ *          (e.g., 215 means 21.5 degrees)
+ */
+void HCSR04::setTemperature(int temperature) {
+  // speed of sound, in tenths of m/s
+  unsigned long speed = 3313 + (606L * temperature) / 1000;
+  // mm per echo uS is speed / 2000, as 16.16 fixed-point value
+  this->mmPerUs = speed * 8192 / 2500;
+};
+
+/**
+ * Send the trigger pulse to the sensor.
+ */
+void HCSR04::sendTriggerPulse() {
+  // The sensor requires a 10uS HIGH pulse
   // to aknoledge that we want a reading.
   // We use 20uS, just in case
   digitalWrite(this->triggerPin, HIGH);
   delayMicroseconds(20);
   digitalWrite(this->triggerPin, LOW);
-  // Detect the length of the HIGH pulse from the echo pin, 
-  // to find out the time needed for the signal sound 
-  // to travel forth and back from the obstacle.
-  d = pulseIn(this->echoPin, HIGH);
+};
+
+/**
+ * Transform the echo duration in a distance.
+ * @param duration
+ *          the echo duration, in microseconds
+ * @param unit
+ *          measurement unit, value of HCSR04::MetricsEL
+ * @return distance in provided measurement unit
+ */
+float HCSR04::toUnit(unsigned long duration, HCSR04::MetricsEL unit) {
   // do the math and compute the distance in cm
-  d = d / 58.2; // distance (in cm) = (pulseTime / 2) / 29.1
+  float d = duration / 58.2; // distance (in cm) = (pulseTime / 2) / 29.1
   // transform in the required measurement unit
   if (unit == MetricsEL::mm) {
     return d * 10;
@@ -53,3 +110,186 @@ float HCSR04::read(HCSR04::MetricsEL unit) {
     return d;
   }
 };
+
+/**
+ * Reads sensor data (blocking, for at most the echo
+ * timeout corresponding to the maximum range).
+ * @param unit
+ *        measurement unit, value of HCSR04::MetricsEL
+ * @return distance in provided measurement unit,
+ *         or -1 if error occured or no obstacle is in range
+ */
+float HCSR04::read(HCSR04::MetricsEL unit) {
+  unsigned long duration = this->echo();
+  // no echo or echo longer than the maximum range
+  if (duration == 0) return -1;
+  return this->toUnit(duration, unit);
+};
+
+/**
+ * Trigger the sensor and measure the echo (blocking, for at most
+ * the echo timeout corresponding to the maximum range).
+ * @return the echo duration in microseconds, or 0 if error
+ *         occured or no obstacle is in range
+ */
+unsigned long HCSR04::echo() {
+  unsigned long duration = 0;
+  this->sendTriggerPulse();
+  // Detect the length of the HIGH pulse from the echo pin,
+  // to find out the time needed for the signal sound
+  // to travel forth and back from the obstacle.
+  // Don't wait longer than the maximum range requires.
+  duration = pulseIn(this->echoPin, HIGH,
+    this->echoTimeout + HCSR04_ECHO_START_TIMEOUT);
+  if (duration > this->echoTimeout) duration = 0;
+  TRACE(TRACE_EV_HCSR04_ECHO, duration > 0xFFFF ? 0xFFFF : duration);
+  return duration;
+};
+
+/**
+ * Reads sensor raw data: the echo duration.
+ * @return echo duration in microseconds,
+ *         or 0 if error occured or no obstacle is in range
+ */
+unsigned long HCSR04::readEcho() {
+  return this->echo();
+};
+
+/**
+ * Reads sensor data, integer only (no floating point math).
+ * @return distance in millimeters,
+ *         or 0 if error occured or no obstacle is in range
+ */
+unsigned int HCSR04::readMm() {
+  return this->toMm(this->echo());
+};
+
+/**
+ * Start an asynchronous measurement. The echo is timed by using
+ * the external interrupt of the echo pin (if the pin has one).
+ * Otherwise, the echo is timed by HCSR04::poll calls, or by
+ * calling HCSR04::echoChange from a pin change interrupt.
+ * @return true if the measurement was started, false if a
+ *         measurement is still in progress or the sensor still
+ *         sends the echo of a previous measurement.
+ */
+bool HCSR04::trigger() {
+  int interruptNr = -1;
+  if (this->status == StatusEL::BUSY
+    || digitalRead(this->echoPin) == HIGH) return false;
+  // attach the echo pin interrupt, if one is available and free
+  if (!this->interruptAttached) {
+#ifdef digitalPinToInterrupt
+    interruptNr = digitalPinToInterrupt(this->echoPin);
+#endif
+    if ((interruptNr == 0 || interruptNr == 1)
+      && HCSR04::isrInstances[interruptNr] == 0) {
+      HCSR04::isrInstances[interruptNr] = this;
+      attachInterrupt(interruptNr,
+        interruptNr == 0 ? HCSR04::isr0 : HCSR04::isr1, CHANGE);
+      this->interruptAttached = true;
+    }
+  }
+  this->status = StatusEL::BUSY;
+  this->echoState = EchoEL::WAIT_HIGH;
+  this->sendTriggerPulse();
+  this->triggerTime = micros();
+  return true;
+};
+
+/**
+ * Check the result of the asynchronous measurement (non-blocking).
+ * @param distance
+ *          reference parameter storing the distance, in the
+ *          provided measurement unit. Set only if status is OK.
+ * @param unit
+ *          measurement unit, value of HCSR04::MetricsEL
+ * @return the measurement status (see HCSR04::StatusEL::xxx)
+ */
+HCSR04::StatusEL HCSR04::poll(float &distance, HCSR04::MetricsEL unit) {
+  if (this->update() == StatusEL::OK)
+    distance = this->toUnit(this->echoDuration, unit);
+  return this->status;
+};
+
+/**
+ * Check the result of the asynchronous measurement (non-blocking),
+ * integer only (no floating point math).
+ * @param distance
+ *          reference parameter storing the distance, in
+ *          millimeters. Set only if status is OK.
+ * @return the measurement status (see HCSR04::StatusEL::xxx)
+ */
+HCSR04::StatusEL HCSR04::poll(unsigned int &distance) {
+  if (this->update() == StatusEL::OK)
+    distance = this->toMm(this->echoDuration);
+  return this->status;
+};
+
+/**
+ * Update the state of the asynchronous measurement.
+ * @return the measurement status (see HCSR04::StatusEL::xxx)
+ */
+HCSR04::StatusEL HCSR04::update() {
+  unsigned long start = 0, end = 0;
+  EchoEL state = EchoEL::IDLE;
+  if (this->status == StatusEL::BUSY) {
+    // no interrupt for the echo pin: sample it now
+    if (!this->interruptAttached) this->echoChange();
+    noInterrupts();
+    state = this->echoState;
+    start = this->echoStart;
+    end = this->echoEnd;
+    interrupts();
+    if (state == EchoEL::DONE) {
+      this->echoDuration = end - start;
+      this->status = (this->echoDuration > this->echoTimeout)
+        ? StatusEL::OUT_OF_RANGE : StatusEL::OK;
+    } else if (state == EchoEL::HIGH_SEEN) {
+      // no need to wait for the sensor to give up (~38ms)
+      if (micros() - start > this->echoTimeout)
+        this->status = StatusEL::OUT_OF_RANGE;
+    } else if (micros() - this->triggerTime > HCSR04_ECHO_START_TIMEOUT) {
+      this->status = StatusEL::TIMEOUT;
+    }
+    // measurement completed, ignore further echo pin changes
+    if (this->status != StatusEL::BUSY) this->echoState = EchoEL::IDLE;
+  }
+  return this->status;
+};
+
+/**
+ * Record an echo pin change. Called from the echo pin interrupt,
+ * but can be also called from a pin change interrupt routine.
+ */
+void HCSR04::echoChange() {
+  this->echoChange(micros());
+};
+
+/**
+ * Record an echo pin change.
+ * @param now
+ *          the time of the change, in microseconds (see micros())
+ */
+void HCSR04::echoChange(unsigned long now) {
+  if (digitalRead(this->echoPin) == HIGH) {
+    if (this->echoState == EchoEL::WAIT_HIGH) {
+      this->echoStart = now;
+      this->echoState = EchoEL::HIGH_SEEN;
+    }
+  } else if (this->echoState == EchoEL::HIGH_SEEN) {
+    this->echoEnd = now;
+    this->echoState = EchoEL::DONE;
+  }
+};
+
+/**
+ * Interrupt service routines for INT0 and INT1.
+ */
+void HCSR04::isr0() {
+  if (HCSR04::isrInstances[0]) HCSR04::isrInstances[0]->echoChange();
+};
+
+void HCSR04::isr1() {
+  if (HCSR04::isrInstances[1]) HCSR04::isrInstances[1]->echoChange();
+};
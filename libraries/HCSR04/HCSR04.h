@@ -7,8 +7,32 @@
 #else
 #include <Arduino.h>
 #endif
+// the Trace library is optional: without it, the TRACE calls are removed
+#if defined(__has_include)
+#if __has_include(<Trace.h>)
+#include <Trace.h>
+#endif
+#endif
+#ifndef TRACE
+#define TRACE(id, arg) ((void)0)
+#endif
 
-class HCSR04 { 
+// The sensor is specified for up to 4 meters (400cm).
+#define HCSR04_DEFAULT_MAX_RANGE 400
+// Upper limit (in centimeters) accepted by setMaxRange: the echo
+// duration (about 233ms) multiplied by the 16.16 fixed-point mm per
+// microsecond factor must fit 32 bits, and the distance in mm must
+// fit an unsigned int.
+#define HCSR04_MAX_RANGE 4000
+// Maximum time (in microseconds) between the end of the trigger
+// pulse and the raising edge of the echo signal. The sensor
+// normally needs about 500 microseconds to send the 8 cycles burst.
+#define HCSR04_ECHO_START_TIMEOUT 5000
+// Millimeters per echo microsecond, as 16.16 fixed-point value
+// (1 / 5.82 * 65536), same as the 58.2uS/cm used by the float methods.
+#define HCSR04_MM_PER_US_Q16 11261
+
+class HCSR04 {
   public:
     enum class MetricsEL: unsigned char {
       mm = 0,
@@ -16,10 +40,82 @@ class HCSR04 {
       m = 2,
       km = 3
     };
-    HCSR04(unsigned char triggerPin, unsigned char echoPin); 
+    // Asynchronous measurement statuses.
+    enum class StatusEL: unsigned char {
+      // NONE ==> no measurement was triggered yet
+      NONE = 0,
+      // BUSY ==> measurement in progress, poll again later
+      BUSY = 1,
+      // OK ==> valid distance value
+      OK = 2,
+      // OUT_OF_RANGE ==> no obstacle within the configured maximum range
+      OUT_OF_RANGE = 4,
+      // TIMEOUT ==> the sensor does not answer, check the connections and the sensor
+      TIMEOUT = 8
+    };
+    HCSR04(unsigned char triggerPin, unsigned char echoPin,
+      unsigned int maxRange = HCSR04_DEFAULT_MAX_RANGE);
+    ~HCSR04();
     float read(MetricsEL unit = MetricsEL::cm);
+    unsigned long readEcho();
+    unsigned int readMm();
+    /**
+     * Reads sensor data, integer only (no floating point math).
+     * The measurement unit is selected at compile time, e.g.,
+     * hcsr04.readInt<HCSR04::MetricsEL::cm>().
+     * NOTE: the value is truncated to an integer number of units,
+     *       so use mm (the default) for the best resolution.
+     * @return distance in the template measurement unit,
+     *         or 0 if error occured or no obstacle is in range
+     */
+    template <MetricsEL unit = MetricsEL::mm>
+    unsigned int readInt() {
+      return this->readMm() / HCSR04::unitDivider(unit);
+    };
+    void setTemperature(int temperature);
+    void setMaxRange(unsigned int maxRange);
+    bool trigger();
+    StatusEL poll(float &distance, MetricsEL unit = MetricsEL::cm);
+    StatusEL poll(unsigned int &distance);
+    void echoChange();
+    void echoChange(unsigned long now);
+    unsigned char getEchoPin() { return this->echoPin; };
   private:
+    // echo signal states, used by the asynchronous measurement
+    enum class EchoEL: unsigned char {
+      IDLE = 0,
+      WAIT_HIGH = 1,
+      HIGH_SEEN = 2,
+      DONE = 3
+    };
     unsigned char triggerPin;
     unsigned char echoPin;
+    // echo duration (in microseconds) for the configured maximum range
+    unsigned long echoTimeout;
+    // asynchronous measurement data
+    unsigned long triggerTime;
+    volatile unsigned long echoStart;
+    volatile unsigned long echoEnd;
+    volatile EchoEL echoState;
+    unsigned long echoDuration;
+    StatusEL status;
+    bool interruptAttached;
+    // millimeters per echo microsecond (16.16 fixed-point)
+    unsigned int mmPerUs;
+    void sendTriggerPulse();
+    unsigned long echo();
+    StatusEL update();
+    float toUnit(unsigned long duration, MetricsEL unit);
+    unsigned int toMm(unsigned long duration) {
+      return ((unsigned long)duration * this->mmPerUs) >> 16;
+    };
+    static constexpr unsigned long unitDivider(MetricsEL unit) {
+      return unit == MetricsEL::cm ? 10UL : unit == MetricsEL::m ? 1000UL
+        : unit == MetricsEL::km ? 1000000UL : 1UL;
+    };
+    // instances using the external interrupts INT0 and INT1
+    static HCSR04* isrInstances[2];
+    static void isr0();
+    static void isr1();
 };
 #endif
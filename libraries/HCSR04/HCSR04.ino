@@ -22,6 +22,6 @@ void loop() {
   }
   // continuously read the sensor, ~10 times/s
   // Note: may be much less than ~10 times/s because reading
-  // the sensor and checking the timeout may take up to 50ms
+  // the sensor and checking the timeout may take up to ~28ms
   delay(100);
 }
@@ -0,0 +1,129 @@
+#include "HCSR04Array.h"
+
+/**
+ * Constructor.
+ * @param unit
+ *          measurement unit used for the distances table,
+ *          value of HCSR04::MetricsEL
+ * @param slotTime
+ *          the time slot length, in milliseconds. One group of
+ *          sensors is fired in every time slot.
+ */
+HCSR04Array::HCSR04Array(HCSR04::MetricsEL unit, unsigned int slotTime) {
+  this->unit = unit;
+  this->slotTime = slotTime;
+  this->count = 0;
+  this->groupsCount = 0;
+  this->slot = 0;
+  this->slotStart = 0;
+  this->pending = 0;
+  this->updates = 0;
+  this->updateRate = 0;
+  this->rateStart = 0;
+  this->cycleStart = 0;
+  this->cycleTime = 0;
+};
+
+/**
+ * Add a sensor to the array.
+ * @param sensor
+ *          the sensor to add
+ * @param group
+ *          the group of the sensor. Sensors of the same group are
+ *          fired at the same time, so they must not hear each other
+ *          (e.g., facing opposite directions). The groups are fired
+ *          one after the other, in time slots, starting with group 0.
+ *          NOTE: use consecutive group numbers (0, 1, 2...)
+ * @return true if the sensor was added, false if the array is full
+ */
+bool HCSR04Array::add(HCSR04 &sensor, unsigned char group) {
+  if (this->count >= HCSR04_ARRAY_MAX_SENSORS) return false;
+  this->sensors[this->count] = &sensor;
+  this->groups[this->count] = group;
+  this->count++;
+  if (group >= this->groupsCount) this->groupsCount = group + 1;
+  return true;
+};
+
+/**
+ * Enable the pin change interrupts for the echo pins
+ * and fire the first group of sensors.
+ */
+void HCSR04Array::begin() {
+  unsigned char pin = 0;
+  for (unsigned char i = 0; i < this->count; i++) {
+    pin = this->sensors[i]->getEchoPin();
+#if defined(digitalPinToPCICR)
+    if (digitalPinToPCICR(pin)) {
+      *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+      *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+    }
+#endif
+  }
+  this->rateStart = millis();
+  this->cycleStart = this->rateStart;
+  this->slot = 0;
+  this->fireSlot();
+};
+
+/**
+ * Trigger all the sensors of the current slot group.
+ */
+void HCSR04Array::fireSlot() {
+  this->slotStart = millis();
+  for (unsigned char i = 0; i < this->count; i++) {
+    // a sensor still sending an old echo is skipped this round
+    if (this->groups[i] == this->slot && this->sensors[i]->trigger())
+      this->pending |= (1 << i);
+  }
+};
+
+/**
+ * Collect the completed measurements and, when the current time
+ * slot is over, fire the next group of sensors. Must be called
+ * as often as possible, e.g., in every loop() call (non-blocking).
+ */
+void HCSR04Array::update() {
+  float distance = 0;
+  HCSR04::StatusEL status = HCSR04::StatusEL::NONE;
+  unsigned long now = millis();
+  if (this->count == 0) return;
+  for (unsigned char i = 0; i < this->count; i++) {
+    if (!(this->pending & (1 << i))) continue;
+    status = this->sensors[i]->poll(distance, this->unit);
+    if (status == HCSR04::StatusEL::BUSY) continue;
+    this->pending &= ~(1 << i);
+    this->entries[i].status = status;
+    this->entries[i].timestamp = now;
+    if (status == HCSR04::StatusEL::OK)
+      this->entries[i].distance = distance;
+    this->updates++;
+  }
+  // all the echoes were received and the time slot is over
+  if (this->pending == 0 && now - this->slotStart >= this->slotTime) {
+    this->slot = (this->slot + 1) % this->groupsCount;
+    if (this->slot == 0) {
+      this->cycleTime = now - this->cycleStart;
+      this->cycleStart = now;
+    }
+    this->fireSlot();
+  }
+  // compute the aggregate update rate, once per second
+  if (now - this->rateStart >= 1000) {
+    this->updateRate = (unsigned long)this->updates * 1000 / (now - this->rateStart);
+    this->updates = 0;
+    this->rateStart = now;
+  }
+};
+
+/**
+ * Forward an echo pin change to the sensors having a measurement
+ * in progress. Called from the pin change interrupt routines
+ * (see HCSR04_ARRAY_ISR).
+ */
+void HCSR04Array::pinChange() {
+  unsigned long now = micros();
+  for (unsigned char i = 0; i < this->count; i++) {
+    if (this->pending & (1 << i)) this->sensors[i]->echoChange(now);
+  }
+};
@@ -0,0 +1,77 @@
+#ifndef HCSR04Array_h
+#define HCSR04Array_h
+
+#include "HCSR04.h"
+
+// Maximum number of sensors managed by one array.
+#define HCSR04_ARRAY_MAX_SENSORS 8
+// Default time slot length (in milliseconds). A slot must be long
+// enough for the echoes of the fired sensors to fade out, otherwise
+// the sensors fired in the next slot receive them (crosstalk).
+#define HCSR04_ARRAY_DEFAULT_SLOT_TIME 40
+
+/**
+ * Define the pin change interrupt routines used to time the echoes
+ * of all the array sensors. Use it ONCE, in the sketch file, e.g.:
+ *   HCSR04Array sonars;
+ *   HCSR04_ARRAY_ISR(sonars)
+ * NOTE: the pin change interrupts are also used by SoftwareSerial,
+ *       so the two can't be used together in the same sketch.
+ */
+#if defined(PCINT2_vect)
+#define HCSR04_ARRAY_ISR(array) \
+  ISR(PCINT0_vect) { array.pinChange(); } \
+  ISR(PCINT1_vect) { array.pinChange(); } \
+  ISR(PCINT2_vect) { array.pinChange(); }
+#elif defined(PCINT0_vect)
+#define HCSR04_ARRAY_ISR(array) \
+  ISR(PCINT0_vect) { array.pinChange(); }
+#else
+#define HCSR04_ARRAY_ISR(array)
+#endif
+
+class HCSR04Array {
+  public:
+    // The latest known measurement of a sensor.
+    struct Entry {
+      // distance, in the array measurement unit
+      float distance = 0.0;
+      // measurement time (see millis())
+      unsigned long timestamp = 0;
+      // measurement status (see HCSR04::StatusEL::xxx)
+      HCSR04::StatusEL status = HCSR04::StatusEL::NONE;
+    };
+    HCSR04Array(HCSR04::MetricsEL unit = HCSR04::MetricsEL::cm,
+      unsigned int slotTime = HCSR04_ARRAY_DEFAULT_SLOT_TIME);
+    bool add(HCSR04 &sensor, unsigned char group);
+    void begin();
+    void update();
+    void pinChange();
+    const Entry& get(unsigned char index) { return this->entries[index]; };
+    unsigned char size() { return this->count; };
+    unsigned int getUpdateRate() { return this->updateRate; };
+    unsigned long getCycleTime() { return this->cycleTime; };
+  private:
+    HCSR04 *sensors[HCSR04_ARRAY_MAX_SENSORS];
+    // sensors of the same group are fired together, so they
+    // must be placed such that they can't hear each other
+    unsigned char groups[HCSR04_ARRAY_MAX_SENSORS];
+    Entry entries[HCSR04_ARRAY_MAX_SENSORS];
+    unsigned char count;
+    unsigned char groupsCount;
+    HCSR04::MetricsEL unit;
+    unsigned int slotTime;
+    // the group fired in the current time slot
+    unsigned char slot;
+    unsigned long slotStart;
+    // bit i is set while the measurement of sensor i is in progress
+    volatile unsigned char pending;
+    // statistics: measurements per second and full cycle time
+    unsigned int updates;
+    unsigned int updateRate;
+    unsigned long rateStart;
+    unsigned long cycleStart;
+    unsigned long cycleTime;
+    void fireSlot();
+};
+#endif
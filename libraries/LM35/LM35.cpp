@@ -0,0 +1,22 @@
+#include "LM35.h"
+
+/**
+ * Convert an ADC value to temperature (integer math only).
+ * The sensor output is 10mV for every Celsius degree, so the
+ * conversion is linear: a multiply and a shift are enough.
+ * @param adc
+ *          the ADC value measured on the sensor output pin
+ * @param resolution
+ *          the ADC value resolution, in bits: 10 for analogRead,
+ *          more if oversampling is used (see AnalogSampler)
+ * @return the temperature, in hundredths of Celsius degree
+ *         (e.g., 2150 means 21.5 degrees), at most
+ *         LM35_MAX_CENTI_CELSIUS (higher values are clamped)
+ */
+int16_t LM35::toCentiCelsius(uint16_t adc, uint8_t resolution) {
+  // mV = adc * LM35_VREF / 2^resolution, and 1mV = 10 centi-degrees
+  uint32_t centiCelsius = ((uint32_t)adc * (LM35_VREF * 10UL)) >> resolution;
+  // clamp, instead of wrapping to negative values
+  if (centiCelsius > LM35_MAX_CENTI_CELSIUS) return LM35_MAX_CENTI_CELSIUS;
+  return centiCelsius;
+};
@@ -0,0 +1,22 @@
+#ifndef LM35_h
+#define LM35_h
+
+#if ARDUINO < 100
+#include <WProgram.h>
+#include <pins_arduino.h>
+#else
+#include <Arduino.h>
+#endif
+
+// the ADC reference voltage, in mV
+#define LM35_VREF 5000
+// maximum reported value: 327.67 degrees (the int16_t limit); the
+// sensor output is at most 150 degrees, so only a wrong wiring or
+// reference voltage may give higher values
+#define LM35_MAX_CENTI_CELSIUS 32767
+
+class LM35 {
+  public:
+    static int16_t toCentiCelsius(uint16_t adc, uint8_t resolution = 10);
+};
+#endif
@@ -0,0 +1,356 @@
+/* 
+ * Implement the SIM900 class.
+ *
+ * @file SIM900.cpp
+ * @version 1.0 
+ */ 
+#include "SIM900.h"
+
+/************************************************************************/
+/* @method                                                              */
+/* Software check if SIM900 module is ok: send AT command               */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::at(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Disable echo: send ATE0 command                                      */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 500                                  */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::ate0(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_ATE0);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Attach to the GPRS service: send AT+CGATT=1 command                  */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 10000                                */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCgatt(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CGATT);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Set the GPRS APN, user name and password: send AT+CSTT command       */
+/* @param apn                                                           */
+/*          the access point name (provided by the mobile operator)     */
+/* @param user                                                          */
+/*          the user name (empty if not required)                       */
+/* @param passwd                                                        */
+/*          the password (empty if not required)                        */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 1000                                 */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCstt(const char* apn, const char* user, 
+  const char* passwd, uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CSTT);
+  this->serial.print(AT_EQUAL);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(apn);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(AT_COMA);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(user);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(AT_COMA);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(passwd);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Bring up the wireless (GPRS) connection: send AT+CIICR command       */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for OK response before gave up)                             */
+/*          NOTE: default value is 30000 (this may take many seconds)   */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCiicr(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CIICR);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Get the local IP address: send AT+CIFSR command. This is required    */
+/* by the SIM900 before a connection can be started.                    */
+/* NOTE: the response is the IP address (no OK), so we wait for a '.'   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for the IP address before gave up)                          */
+/*          NOTE: default value is 1000                                 */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCifsr(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CIFSR);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout('.', timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Start a TCP connection: send AT+CIPSTART="TCP" command               */
+/* @param remoteHost                                                    */
+/*          the IP or the domain name of the remote side                */
+/* @param remotePort                                                    */
+/*          the port of the remote side                                 */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for CONNECT OK response before gave up)                     */
+/*          NOTE: default value is 10000                                */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCipstartTcp(const char* remoteHost, 
+  uint16_t remotePort, uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CIPSTART_TCP);
+  this->serial.print(AT_COMA);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(remoteHost);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(AT_COMA);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(remotePort);
+  this->serial.print(AT_DQUOTE);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeoutPM(SIM900_PGM_AT_CIPSTART_CONNECT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send the AT+CIPSEND=dataLen command and wait for the '>' prompt      */
+/* @param dataLen                                                       */
+/*          the number of bytes to be sent                              */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for the '>' prompt          */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::sendCipsendHeader(uint16_t dataLen, uint16_t timeout) {
+  if (dataLen < 1) return Error::EMPTY_DATA;
+  this->sendPM(SIM900_PGM_AT_CIPSEND);
+  this->serial.print(AT_EQUAL);
+  this->serial.print(dataLen);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeout(AT_GREATER_THAN, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send data over the TCP connection: execute AT+CIPSEND command        */
+/* @param data                                                          */
+/*          data to send (may contain any byte value, including 0)      */
+/* @param dataLen                                                       */
+/*          the number of bytes to send                                 */
+/* @param timeout                                                       */
+/*          timeout in milliseconds to wait for SEND OK answer          */
+/*          NOTE: default value is 5000                                 */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCipsend(const uint8_t *data, uint16_t dataLen, 
+  uint16_t timeout) {
+  Error error = Error::NONE;
+  long remainingTimeout = 0;
+  this->startTimer();
+  error = this->sendCipsendHeader(dataLen, timeout);
+  if (error != Error::NONE) return error;
+  this->serial.write(data, dataLen);
+  remainingTimeout = this->remainingTime(timeout);
+  if (remainingTimeout < 0) return Error::TIMEOUT;
+  return this->checkTimeoutPM(SIM900_PGM_AT_CIPSEND_SEND_OK, remainingTimeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Close the TCP connection: send AT+CIPCLOSE command                   */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for CLOSE OK response before gave up)                       */
+/*          NOTE: default value is 2000                                 */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCipclose(uint16_t timeout) {
+  this->sendPM(SIM900_PGM_AT_CIPCLOSE);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeoutPM(SIM900_PGM_AT_CIPCLOSE_CLOSE_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Deactivate the GPRS context: send AT+CIPSHUT command                 */
+/* @param timeout                                                       */
+/*          timeout in milliseconds for this command ( the time to wait */
+/*          for SHUT OK response before gave up)                        */
+/*          NOTE: default value is 5000                                 */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::atCipshut(uint16_t timeout) {
+  this->sessionOpen = false;
+  this->sendPM(SIM900_PGM_AT_CIPSHUT);
+  this->serial.print(AT_CMD_END);
+  return this->checkTimeoutPM(SIM900_PGM_AT_CIPSHUT_SHUT_OK, timeout);
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Bring up the GPRS session (AT+CGATT, AT+CSTT, AT+CIICR, AT+CIFSR).   */
+/* This takes many seconds, so it is done only if the session is not    */
+/* already open: it is reused by all the following batches.             */
+/* @param apn                                                           */
+/*          the access point name (provided by the mobile operator)     */
+/* @param user                                                          */
+/*          the user name (empty if not required)                       */
+/* @param passwd                                                        */
+/*          the password (empty if not required)                        */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::XXX otherwise   */
+/************************************************************************/
+SIM900::Error SIM900::openSession(const char* apn, const char* user, 
+  const char* passwd) {
+  Error error = Error::NONE;
+  if (this->sessionOpen) return Error::NONE;
+  // start from a known state (any previous context is deactivated)
+  this->atCipshut();
+  this->clearSerialBuffer();
+  if ((error = this->atCgatt()) != Error::NONE) return error;
+  if ((error = this->atCstt(apn, user, passwd)) != Error::NONE) return error;
+  if ((error = this->atCiicr()) != Error::NONE) return error;
+  if ((error = this->atCifsr()) != Error::NONE) return error;
+  this->clearSerialBuffer();
+  this->sessionOpen = true;
+  return Error::NONE;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Close the GPRS session, e.g., before a long sleep.                   */
+/************************************************************************/
+void SIM900::closeSession() {
+  this->atCipshut();
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send a batch of data over TCP, by using the open GPRS session: the   */
+/* connection is started, the data is sent, then the connection is      */
+/* closed. If the connection fails, the session is closed, so the next  */
+/* openSession call brings it up again.                                 */
+/* @param remoteHost                                                    */
+/*          the IP or the domain name of the remote side                */
+/* @param remotePort                                                    */
+/*          the port of the remote side                                 */
+/* @param data                                                          */
+/*          the batch data (e.g., encoded with SampleEncoder)           */
+/* @param dataLen                                                       */
+/*          the batch data length                                       */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::NO_SESSION if   */
+/*         no session is open, SIM900::Error::XXX otherwise             */
+/************************************************************************/
+SIM900::Error SIM900::sendBatch(const char* remoteHost, uint16_t remotePort, 
+  const uint8_t *data, uint16_t dataLen) {
+  Error error = Error::NONE;
+  if (!this->sessionOpen) return Error::NO_SESSION;
+  error = this->atCipstartTcp(remoteHost, remotePort);
+  if (error != Error::NONE) {
+    this->atCipshut();
+    return error;
+  }
+  error = this->atCipsend(data, dataLen);
+  this->atCipclose();
+  return error;
+};
+
+/************************************************************************/
+/* @method                                                              */
+/* Send a batch of data as the body of an HTTP POST request, by using   */
+/* the open GPRS session (see sendBatch).                               */
+/* @param remoteHost                                                    */
+/*          the IP or the domain name of the HTTP server                */
+/* @param remotePort                                                    */
+/*          the port of the HTTP server                                 */
+/* @param path                                                          */
+/*          the request path, e.g., "/data"                             */
+/* @param data                                                          */
+/*          the batch data (the request body)                           */
+/* @param dataLen                                                       */
+/*          the batch data length                                       */
+/* @return SIM900::Error_NONE if all OK, SIM900::Error::NO_SESSION if   */
+/*         no session is open, SIM900::Error::XXX otherwise             */
+/************************************************************************/
+SIM900::Error SIM900::postBatch(const char* remoteHost, uint16_t remotePort, 
+  const char* path, const uint8_t *data, uint16_t dataLen) {
+  Error error = Error::NONE;
+  long remainingTimeout = 0;
+  const uint16_t timeout = 5000;
+  uint16_t requestLen = 0;
+  if (!this->sessionOpen) return Error::NO_SESSION;
+  if (dataLen < 1) return Error::EMPTY_DATA;
+  /**
+   * the POST request is:
+   *
+   * POST /path HTTP/1.1\r\n
+   * Host: host\r\n
+   * Content-Length: 14\r\n
+   * Content-Type: application/octet-stream\r\n
+   * Connection: close\r\n\r\n
+   * data
+   */
+  requestLen = strlen_P(SIM900_PGM_HTTP_POST) + strlen(path) 
+    + strlen_P(SIM900_PGM_HTTP_VERSION) + strlen(remoteHost)
+    + strlen_P(SIM900_PGM_HTTP_CONTENT_LENGTH) + getDigitsCount(dataLen)
+    + strlen_P(SIM900_PGM_HTTP_CONTENT_TYPE) 
+    + strlen_P(SIM900_PGM_HTTP_OCTET_STREAM)
+    + strlen_P(SIM900_PGM_HTTP_HEADERS_END) + dataLen;
+  error = this->atCipstartTcp(remoteHost, remotePort);
+  if (error != Error::NONE) {
+    this->atCipshut();
+    return error;
+  }
+  this->startTimer();
+  error = this->sendCipsendHeader(requestLen, timeout);
+  if (error == Error::NONE) {
+    this->sendPM(SIM900_PGM_HTTP_POST);
+    this->serial.print(path);
+    this->sendPM(SIM900_PGM_HTTP_VERSION);
+    this->serial.print(remoteHost);
+    this->sendPM(SIM900_PGM_HTTP_CONTENT_LENGTH);
+    this->serial.print(dataLen);
+    this->sendPM(SIM900_PGM_HTTP_CONTENT_TYPE);
+    this->sendPM(SIM900_PGM_HTTP_OCTET_STREAM);
+    this->sendPM(SIM900_PGM_HTTP_HEADERS_END);
+    this->serial.write(data, dataLen);
+    remainingTimeout = this->remainingTime(timeout);
+    if (remainingTimeout < 0) error = Error::TIMEOUT;
+    else error = this->checkTimeoutPM(SIM900_PGM_AT_CIPSEND_SEND_OK, 
+      remainingTimeout);
+  }
+  this->atCipclose();
+  return error;
+};
@@ -0,0 +1,66 @@
+/*
+ * SIM900 GSM/GPRS module driver (AT commands over UART).
+ *
+ * @file SIM900.h
+ * @version 1.0
+ */ 
+#ifndef __SIM900_H__
+#define __SIM900_H__
+
+#include <ATTransport.h>
+#include <Arduino.h>
+
+class SIM900: public ATTransport {
+  public:
+    SIM900( Stream& ser): ATTransport( ser) {
+      this->sessionOpen = false;
+    };
+    Error at(uint16_t timeout = 500);
+    Error ate0(uint16_t timeout = 500);
+    Error atCgatt(uint16_t timeout = 10000);
+    Error atCstt(const char* apn, const char* user = "", 
+      const char* passwd = "", uint16_t timeout = 1000);
+    Error atCiicr(uint16_t timeout = 30000);
+    Error atCifsr(uint16_t timeout = 1000);
+    Error atCipstartTcp(const char* remoteHost, uint16_t remotePort, 
+      uint16_t timeout = 10000);
+    Error atCipsend(const uint8_t *data, uint16_t dataLen, 
+      uint16_t timeout = 5000);
+    Error atCipclose(uint16_t timeout = 2000);
+    Error atCipshut(uint16_t timeout = 5000);
+    Error openSession(const char* apn, const char* user = "", 
+      const char* passwd = "");
+    void closeSession();
+    bool isSessionOpen() { return this->sessionOpen; };
+    Error sendBatch(const char* remoteHost, uint16_t remotePort, 
+      const uint8_t *data, uint16_t dataLen);
+    Error postBatch(const char* remoteHost, uint16_t remotePort, 
+      const char* path, const uint8_t *data, uint16_t dataLen);
+
+  private:
+    // true while the GPRS context is active
+    bool sessionOpen;
+    Error sendCipsendHeader(uint16_t dataLen, uint16_t timeout);
+};
+// constants stored in Program Memory (FLASH)
+const char SIM900_PGM_AT[] PROGMEM = "AT";
+const char SIM900_PGM_ATE0[] PROGMEM = "ATE0";
+const char SIM900_PGM_AT_CGATT[] PROGMEM = "AT+CGATT=1";
+const char SIM900_PGM_AT_CSTT[] PROGMEM = "AT+CSTT";
+const char SIM900_PGM_AT_CIICR[] PROGMEM = "AT+CIICR";
+const char SIM900_PGM_AT_CIFSR[] PROGMEM = "AT+CIFSR";
+const char SIM900_PGM_AT_CIPSTART_TCP[] PROGMEM = "AT+CIPSTART=\"TCP\"";
+const char SIM900_PGM_AT_CIPSTART_CONNECT_OK[] PROGMEM = "CONNECT OK";
+const char SIM900_PGM_AT_CIPSEND[] PROGMEM = "AT+CIPSEND";
+const char SIM900_PGM_AT_CIPSEND_SEND_OK[] PROGMEM = "SEND OK";
+const char SIM900_PGM_AT_CIPCLOSE[] PROGMEM = "AT+CIPCLOSE";
+const char SIM900_PGM_AT_CIPCLOSE_CLOSE_OK[] PROGMEM = "CLOSE OK";
+const char SIM900_PGM_AT_CIPSHUT[] PROGMEM = "AT+CIPSHUT";
+const char SIM900_PGM_AT_CIPSHUT_SHUT_OK[] PROGMEM = "SHUT OK";
+const char SIM900_PGM_HTTP_POST[] PROGMEM = "POST ";
+const char SIM900_PGM_HTTP_VERSION[] PROGMEM = " HTTP/1.1\r\nHost: ";
+const char SIM900_PGM_HTTP_CONTENT_LENGTH[] PROGMEM = "\r\nContent-Length: ";
+const char SIM900_PGM_HTTP_CONTENT_TYPE[] PROGMEM = "\r\nContent-Type: ";
+const char SIM900_PGM_HTTP_OCTET_STREAM[] PROGMEM = "application/octet-stream";
+const char SIM900_PGM_HTTP_HEADERS_END[] PROGMEM = "\r\nConnection: close\r\n\r\n";
+#endif
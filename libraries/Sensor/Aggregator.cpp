@@ -0,0 +1,129 @@
+#include "Aggregator.h"
+
+/**
+ * Constructor.
+ * @param heartbeat
+ *          the heartbeat interval, in milliseconds
+ */
+Aggregator::Aggregator(unsigned long heartbeat) {
+  this->heartbeat = heartbeat;
+  this->sent = 0;
+  this->suppressed = 0;
+  this->ignored = 0;
+};
+
+/**
+ * Set the deadband of a channel: changes smaller or equal
+ * with it, relative to the latest reported value, are not
+ * reported (until the heartbeat interval expires).
+ * @param channel
+ *          the channel
+ * @param deadband
+ *          the deadband, in the channel value scale (e.g.,
+ *          50 means 0.5 degrees for the DhtSensor temperature)
+ */
+void Aggregator::setDeadband(uint8_t channel, int32_t deadband) {
+  if (channel >= AGGREGATOR_MAX_CHANNELS) return;
+  this->windows[channel].deadband = deadband;
+};
+
+/**
+ * Fill in a record with the window data and start a new window.
+ * @param window
+ *          the aggregation window
+ * @param channel
+ *          the window channel
+ * @param reason
+ *          why the record is emitted
+ * @param record
+ *          the record to fill in
+ */
+void Aggregator::emit(Window &window, uint8_t channel, ReasonEL reason,
+  Record &record) {
+  record.value = window.last;
+  record.timestamp = window.lastTimestamp;
+  record.min = window.min;
+  record.max = window.max;
+  record.mean = window.sum / window.count;
+  record.count = window.count;
+  record.channel = channel;
+  record.reason = reason;
+  window.reported = window.last;
+  window.reportedTimestamp = window.lastTimestamp;
+  window.hasReported = true;
+  window.pending = false;
+  window.count = 0;
+  this->sent++;
+};
+
+/**
+ * Check if a value moved beyond the deadband of a window.
+ * @param window
+ *          the aggregation window
+ * @param value
+ *          the value
+ * @return true if the value is beyond the deadband, relative
+ *         to the latest reported value
+ */
+bool Aggregator::isBeyondDeadband(Window &window, int32_t value) {
+  // 64 bits: the difference of two int32 values may overflow
+  int64_t delta = (int64_t)value - window.reported;
+  return delta > window.deadband || delta < -(int64_t)window.deadband;
+};
+
+/**
+ * Aggregate a sample. Samples with a status other
+ * than OK are ignored.
+ * @param sample
+ *          the sample
+ * @param record
+ *          reference parameter storing the emitted record
+ * @return true if a record was emitted (and must be reported)
+ */
+bool Aggregator::add(const Sensor::Sample &sample, Record &record) {
+  int32_t sum = 0;
+  bool windowFull = false;
+  if (sample.status != Sensor::StatusEL::OK
+    || sample.channel >= AGGREGATOR_MAX_CHANNELS) {
+    this->ignored++;
+    return false;
+  }
+  Window &window = this->windows[sample.channel];
+  // the window is full: report it and start a new one
+  if (window.count > 0 && (window.count == 0xFFFF
+    || __builtin_add_overflow(window.sum, sample.value, &sum))) {
+    this->emit(window, sample.channel, ReasonEL::WINDOW_FULL, record);
+    windowFull = true;
+  }
+  // add the sample to the window
+  if (window.count == 0) {
+    window.min = sample.value;
+    window.max = sample.value;
+    window.sum = 0;
+  } else if (sample.value < window.min) {
+    window.min = sample.value;
+  } else if (sample.value > window.max) {
+    window.max = sample.value;
+  }
+  window.sum += sample.value;
+  window.count++;
+  window.last = sample.value;
+  window.lastTimestamp = sample.timestamp;
+  // the full window was already reported (one record per call), so
+  // a sample beyond the deadband is reported by the next call
+  if (windowFull) {
+    window.pending = this->isBeyondDeadband(window, sample.value);
+    return true;
+  }
+  if (!window.hasReported) {
+    this->emit(window, sample.channel, ReasonEL::FIRST, record);
+  } else if (window.pending || this->isBeyondDeadband(window, sample.value)) {
+    this->emit(window, sample.channel, ReasonEL::DEADBAND, record);
+  } else if (sample.timestamp - window.reportedTimestamp >= this->heartbeat) {
+    this->emit(window, sample.channel, ReasonEL::HEARTBEAT, record);
+  } else {
+    this->suppressed++;
+    return false;
+  }
+  return true;
+};
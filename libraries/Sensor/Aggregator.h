@@ -0,0 +1,81 @@
+#ifndef Aggregator_h
+#define Aggregator_h
+
+#include "Sensor.h"
+
+// Maximum number of aggregated channels: channels 0 to
+// AGGREGATOR_MAX_CHANNELS - 1 can be used.
+#define AGGREGATOR_MAX_CHANNELS 8
+// Default heartbeat interval (in milliseconds): a record is
+// emitted at least this often, even if the value is unchanged.
+#define AGGREGATOR_DEFAULT_HEARTBEAT 600000UL
+
+/**
+ * Aggregates samples and decides when they are worth reporting.
+ * For every channel, the min, max, mean and count of the samples
+ * since the last report are computed incrementally (O(1) memory).
+ * A record is emitted only when the value moves beyond the channel
+ * deadband, or when the heartbeat interval expires.
+ */
+class Aggregator {
+  public:
+    // Why a record was emitted.
+    enum class ReasonEL: unsigned char {
+      // FIRST ==> first value of the channel
+      FIRST = 0,
+      // DEADBAND ==> the value moved beyond the deadband
+      DEADBAND = 1,
+      // HEARTBEAT ==> the heartbeat interval expired
+      HEARTBEAT = 2,
+      // WINDOW_FULL ==> too many samples, the sum would overflow
+      WINDOW_FULL = 3
+    };
+    // Aggregated data, for one channel, since the previous record.
+    struct Record {
+      // the latest sample value and timestamp
+      int32_t value = 0;
+      uint32_t timestamp = 0;
+      int32_t min = 0;
+      int32_t max = 0;
+      int32_t mean = 0;
+      // number of aggregated samples
+      uint16_t count = 0;
+      uint8_t channel = 0;
+      ReasonEL reason = ReasonEL::FIRST;
+    };
+    Aggregator(unsigned long heartbeat = AGGREGATOR_DEFAULT_HEARTBEAT);
+    void setDeadband(uint8_t channel, int32_t deadband);
+    bool add(const Sensor::Sample &sample, Record &record);
+    // number of emitted records
+    unsigned long getSent() { return this->sent; };
+    // number of samples aggregated without emitting a record
+    unsigned long getSuppressed() { return this->suppressed; };
+    // number of ignored samples (status not OK, or unknown channel)
+    unsigned long getIgnored() { return this->ignored; };
+  private:
+    // Aggregation window of one channel.
+    struct Window {
+      int32_t min = 0;
+      int32_t max = 0;
+      int32_t sum = 0;
+      int32_t last = 0;
+      uint32_t lastTimestamp = 0;
+      uint16_t count = 0;
+      // the latest reported value and its time
+      int32_t reported = 0;
+      uint32_t reportedTimestamp = 0;
+      bool hasReported = false;
+      // the first sample after a WINDOW_FULL record moved beyond
+      // the deadband, so the next sample must be reported
+      bool pending = false;
+      int32_t deadband = 0;
+    };
+    Window windows[AGGREGATOR_MAX_CHANNELS];
+    unsigned long heartbeat;
+    unsigned long sent;
+    unsigned long suppressed;
+    unsigned long ignored;
+    void emit(Window &window, uint8_t channel, ReasonEL reason, Record &record);
+    bool isBeyondDeadband(Window &window, int32_t value);
+};
+#endif
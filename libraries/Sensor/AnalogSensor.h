@@ -0,0 +1,28 @@
+#ifndef AnalogSensor_h
+#define AnalogSensor_h
+
+#include "Sensor.h"
+#include <AnalogSampler.h>
+
+/**
+ * Sensor adapter for analog pins sampled by an AnalogSampler.
+ * Channels:
+ *   - channel: averaged raw ADC value (10 + oversampling bits)
+ * A sample is provided only when a new value was obtained.
+ */
+class AnalogSensor: public Sensor {
+  public:
+    AnalogSensor(AnalogSampler &sampler, uint8_t samplerChannel, uint8_t channel):
+      Sensor(channel), sampler(sampler), samplerChannel(samplerChannel) {};
+    uint8_t getChannels() { return 1; };
+    uint8_t read(Sample samples[]) {
+      if (!this->sampler.available(this->samplerChannel)) return 0;
+      this->setSample(samples[0], 0, this->sampler.read(this->samplerChannel),
+        StatusEL::OK, millis());
+      return 1;
+    };
+  private:
+    AnalogSampler &sampler;
+    uint8_t samplerChannel;
+};
+#endif
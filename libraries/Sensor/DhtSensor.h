@@ -0,0 +1,52 @@
+#ifndef DhtSensor_h
+#define DhtSensor_h
+
+#include "Sensor.h"
+#include <DHTxx.h>
+
+/**
+ * Sensor adapter for DHTxx sensors. Channels:
+ *   - channel: temperature, hundredths of Celsius degree
+ *   - channel + 1: humidity, hundredths of %RH
+ * A new reading is made only after the sensor minimum interval (see
+ * Dht::getMinInterval), otherwise read returns 0 (no new samples), so
+ * the same reading is never provided twice, with different timestamps.
+ * NOTE: the reading blocks for about 5ms (see Dht::read).
+ */
+class DhtSensor: public Sensor {
+  public:
+    DhtSensor(Dht &dht, uint8_t channel): Sensor(channel), dht(dht) {};
+    uint8_t getChannels() { return 2; };
+    uint8_t read(Sample samples[]) {
+      Dht::Result result;
+      unsigned long now = millis();
+      StatusEL status = StatusEL::NONE;
+      if (this->started && now - this->timestamp < this->dht.getMinInterval()) {
+        return 0;
+      }
+      result = this->dht.read();
+      // the reading time (after it, such that the Dht reuse window
+      // is over for the next reading)
+      now = millis();
+      this->timestamp = now;
+      this->started = true;
+      if (result.status == Dht::StatusEL::OK) status = StatusEL::OK;
+      else if (result.status == Dht::StatusEL::CRC_ERROR) status = StatusEL::ERROR;
+      else if (result.status == Dht::StatusEL::TIMEOUT) status = StatusEL::TIMEOUT;
+      this->setSample(samples[0], 0,
+        DhtSensor::toFixed(result.temperature), status, now);
+      this->setSample(samples[1], 1,
+        DhtSensor::toFixed(result.humidity), status, now);
+      return 2;
+    };
+  private:
+    Dht &dht;
+    // the time of the last reading, if one was made
+    unsigned long timestamp = 0;
+    bool started = false;
+    // the sensor resolution is 0.1, so rounding to 0.01 is exact
+    static int32_t toFixed(float value) {
+      return (int32_t)(value * 100 + (value < 0 ? -0.5 : 0.5));
+    };
+};
+#endif
@@ -0,0 +1,218 @@
+#include "EepromQueue.h"
+
+/**
+ * Constructor.
+ * @param start
+ *          the first EEPROM address used by the queue
+ * @param size
+ *          the number of EEPROM bytes used by the queue
+ */
+EepromQueue::EepromQueue(uint16_t start, uint16_t size) {
+  this->start = start;
+  size -= EEPROM_QUEUE_TAIL_SLOTS * sizeof(Tail);
+  this->capacity = size / sizeof(Record);
+  this->head = 0;
+  this->tail = 0;
+  this->tailSlot = 0;
+  this->writes = 0;
+  this->dropped = 0;
+  this->flushed = 0;
+  this->flushStart = 0;
+  this->flushTime = 0;
+};
+
+/**
+ * CRC-8 (polynomial 0x31), computed over a memory area.
+ * @param data
+ *          the data
+ * @param length
+ *          the data length
+ * @return the CRC value
+ */
+uint8_t EepromQueue::crc8(const uint8_t *data, uint8_t length) {
+  uint8_t crc = EEPROM_QUEUE_CRC_INIT;
+  while (length--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+  }
+  return crc;
+};
+
+/**
+ * Write data in EEPROM. Only the changed bytes are written.
+ */
+void EepromQueue::writeBytes(uint16_t address, const uint8_t *data,
+  uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) {
+    if (EEPROM.read(address + i) != data[i]) {
+      EEPROM.write(address + i, data[i]);
+      this->writes++;
+    }
+  }
+};
+
+/**
+ * Read data from EEPROM.
+ */
+void EepromQueue::readBytes(uint16_t address, uint8_t *data, uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) data[i] = EEPROM.read(address + i);
+};
+
+/**
+ * Get the EEPROM address of a record. The tail slots
+ * are stored first, then the records.
+ * @param sequence
+ *          the record sequence number
+ * @return the record address
+ */
+uint16_t EepromQueue::recordAddress(uint32_t sequence) {
+  return this->start + EEPROM_QUEUE_TAIL_SLOTS * sizeof(Tail)
+    + (sequence % this->capacity) * sizeof(Record);
+};
+
+/**
+ * Read and check a record.
+ * @return true if the record is valid (correct CRC)
+ */
+bool EepromQueue::readRecordAt(uint16_t address, Record &record) {
+  this->readBytes(address, (uint8_t*)&record, sizeof(Record));
+  return record.sequence != 0xFFFFFFFF
+    && record.crc == EepromQueue::crc8((uint8_t*)&record, offsetof(Record, crc));
+};
+
+/**
+ * Read and check the record with the given sequence number.
+ * @return true if the record is valid and has the sequence number
+ */
+bool EepromQueue::readRecord(uint32_t sequence, Record &record) {
+  return this->readRecordAt(this->recordAddress(sequence), record)
+    && record.sequence == sequence;
+};
+
+/**
+ * Recover the queue state from EEPROM. Must be called once,
+ * before using the queue (e.g., in setup()).
+ */
+void EepromQueue::begin() {
+  Record record;
+  Tail tail;
+  uint16_t address = 0;
+  bool found = false;
+  if (this->capacity == 0) return;
+  // the head follows the record with the highest sequence number
+  this->head = 0;
+  for (uint16_t i = 0; i < this->capacity; i++) {
+    if (this->readRecordAt(this->recordAddress(i), record)
+      && (!found || record.sequence >= this->head)) {
+      this->head = record.sequence + 1;
+      found = true;
+    }
+  }
+  // the tail is the highest valid stored tail value
+  this->tail = 0;
+  this->tailSlot = 0;
+  for (uint8_t i = 0; i < EEPROM_QUEUE_TAIL_SLOTS; i++) {
+    address = this->start + i * sizeof(Tail);
+    this->readBytes(address, (uint8_t*)&tail, sizeof(Tail));
+    if (tail.sequence != 0xFFFFFFFF
+      && tail.crc == EepromQueue::crc8((uint8_t*)&tail, offsetof(Tail, crc))
+      && tail.sequence >= this->tail) {
+      this->tail = tail.sequence;
+      this->tailSlot = (i + 1) % EEPROM_QUEUE_TAIL_SLOTS;
+    }
+  }
+  // the oldest records may have been overwritten
+  if (this->tail > this->head) this->tail = this->head;
+  if (this->head - this->tail > this->capacity)
+    this->tail = this->head - this->capacity;
+};
+
+/**
+ * Store the tail in the next tail slot (round-robin).
+ */
+void EepromQueue::writeTail() {
+  Tail tail;
+  tail.sequence = this->tail;
+  tail.crc = EepromQueue::crc8((uint8_t*)&tail, offsetof(Tail, crc));
+  this->writeBytes(this->start + this->tailSlot * sizeof(Tail),
+    (uint8_t*)&tail, sizeof(Tail));
+  this->tailSlot = (this->tailSlot + 1) % EEPROM_QUEUE_TAIL_SLOTS;
+};
+
+/**
+ * Add a sample to the queue. If the queue is full, the
+ * oldest sample is overwritten. An EEPROM write needs
+ * about 3.3ms for every changed byte.
+ * @param sample
+ *          the sample
+ * @return true if the sample was added
+ */
+bool EepromQueue::push(const Sensor::Sample &sample) {
+  Record record;
+  if (this->capacity == 0) return false;
+  // full: the oldest sample is lost
+  if (this->head - this->tail >= this->capacity) {
+    this->tail++;
+    this->dropped++;
+  }
+  record.sequence = this->head;
+  record.sample = sample;
+  record.crc = EepromQueue::crc8((uint8_t*)&record, offsetof(Record, crc));
+  this->writeBytes(this->recordAddress(this->head), (uint8_t*)&record,
+    sizeof(Record));
+  this->head++;
+  return true;
+};
+
+/**
+ * Read the oldest samples, without removing them. After they
+ * are sent, use pop to remove them. Corrupted records are skipped.
+ * @param samples
+ *          array where the samples are stored
+ * @param n
+ *          the maximum number of samples to read (the array size)
+ * @return the number of samples stored in the array
+ */
+uint8_t EepromQueue::peek(Sensor::Sample samples[], uint8_t n) {
+  Record record;
+  uint8_t count = 0;
+  if (this->flushStart == 0) this->flushStart = millis() | 1;
+  for (uint32_t s = this->tail; s != this->head && count < n; s++) {
+    if (this->readRecord(s, record)) samples[count++] = record.sample;
+  }
+  return count;
+};
+
+/**
+ * Remove the oldest samples, e.g., after they were sent.
+ * The new tail is stored in EEPROM.
+ * @param n
+ *          the number of samples to remove (the value returned by peek)
+ */
+void EepromQueue::pop(uint8_t n) {
+  Record record;
+  // skip the same corrupted records as peek did
+  while (n > 0 && this->tail != this->head) {
+    if (this->readRecord(this->tail, record)) {
+      n--;
+      this->flushed++;
+    }
+    this->tail++;
+  }
+  this->writeTail();
+  if (this->flushStart != 0) {
+    this->flushTime += millis() - this->flushStart;
+    this->flushStart = 0;
+  }
+};
+
+/**
+ * Get the flush throughput: the flushed samples per second,
+ * measured from the peek call to the corresponding pop call.
+ * @return the number of samples flushed per second
+ */
+uint16_t EepromQueue::getFlushRate() {
+  if (this->flushTime == 0) return 0;
+  return (uint32_t)this->flushed * 1000 / this->flushTime;
+};
@@ -0,0 +1,79 @@
+#ifndef EepromQueue_h
+#define EepromQueue_h
+
+#include "Sensor.h"
+#include <EEPROM.h>
+#include <stddef.h>
+
+// Number of slots used to store the tail (the oldest not yet
+// flushed sample). They are written round-robin (wear levelling).
+#define EEPROM_QUEUE_TAIL_SLOTS 8
+// Initial value of the records CRC, makes the erased (0xFF)
+// EEPROM and the data of other applications look invalid.
+#define EEPROM_QUEUE_CRC_INIT 0x5A
+
+/**
+ * Persistent circular queue of samples, stored in EEPROM. Used
+ * to keep the samples while offline, and to flush them in large
+ * batches when the link returns.
+ *   - every record has a sequence number and a CRC, so the queue
+ *     head is recovered at startup by scanning the records: a
+ *     record partially written when the power was lost is invalid.
+ *   - the tail is written in one of EEPROM_QUEUE_TAIL_SLOTS slots,
+ *     round-robin, also with a CRC: if the power is lost while
+ *     writing it, the previous one is used (the samples are sent
+ *     again, but never lost).
+ *   - the records are written round-robin, so all the queue
+ *     EEPROM cells are written equally often (wear levelling).
+ * When the queue is full, the oldest samples are overwritten.
+ */
+class EepromQueue {
+  public:
+    EepromQueue(uint16_t start = 0, uint16_t size = E2END + 1);
+    void begin();
+    bool push(const Sensor::Sample &sample);
+    uint8_t peek(Sensor::Sample samples[], uint8_t n);
+    void pop(uint8_t n);
+    uint16_t getDepth() { return this->head - this->tail; };
+    uint16_t getCapacity() { return this->capacity; };
+    // number of EEPROM bytes written (since begin)
+    unsigned long getWrites() { return this->writes; };
+    // number of overwritten (lost) samples, because the queue was full
+    unsigned long getDropped() { return this->dropped; };
+    // number of flushed samples (removed with pop)
+    unsigned long getFlushed() { return this->flushed; };
+    uint16_t getFlushRate();
+  private:
+    // One stored sample.
+    struct Record {
+      uint32_t sequence;
+      Sensor::Sample sample;
+      uint8_t crc;
+    };
+    // One stored tail value.
+    struct Tail {
+      uint32_t sequence;
+      uint8_t crc;
+    };
+    uint16_t start;
+    uint16_t capacity;
+    // the sequence number of the next pushed sample
+    uint32_t head;
+    // the sequence number of the oldest not flushed sample
+    uint32_t tail;
+    uint8_t tailSlot;
+    unsigned long writes;
+    unsigned long dropped;
+    unsigned long flushed;
+    // flush throughput measurement
+    unsigned long flushStart;
+    unsigned long flushTime;
+    uint16_t recordAddress(uint32_t sequence);
+    bool readRecord(uint32_t sequence, Record &record);
+    bool readRecordAt(uint16_t address, Record &record);
+    void writeTail();
+    void writeBytes(uint16_t address, const uint8_t *data, uint8_t length);
+    void readBytes(uint16_t address, uint8_t *data, uint8_t length);
+    static uint8_t crc8(const uint8_t *data, uint8_t length);
+};
+#endif
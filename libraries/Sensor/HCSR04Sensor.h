@@ -0,0 +1,41 @@
+#ifndef HCSR04Sensor_h
+#define HCSR04Sensor_h
+
+#include "Sensor.h"
+#include <HCSR04.h>
+
+/**
+ * Sensor adapter for HCSR04 sensors (non-blocking). Channels:
+ *   - channel: distance, millimeters
+ * Every read call checks the measurement in progress and, if
+ * it is completed, provides the sample and triggers a new one.
+ */
+class HCSR04Sensor: public Sensor {
+  public:
+    HCSR04Sensor(HCSR04 &hcsr04, uint8_t channel): Sensor(channel), hcsr04(hcsr04) {};
+    uint8_t getChannels() { return 1; };
+    uint8_t read(Sample samples[]) {
+      unsigned int distance = 0;
+      uint8_t n = 0;
+      StatusEL status = StatusEL::NONE;
+      HCSR04::StatusEL result = HCSR04::StatusEL::NONE;
+      if (this->measuring) {
+        result = this->hcsr04.poll(distance);
+        if (result == HCSR04::StatusEL::BUSY) return 0;
+        if (result == HCSR04::StatusEL::OK) status = StatusEL::OK;
+        else if (result == HCSR04::StatusEL::OUT_OF_RANGE) status = StatusEL::OUT_OF_RANGE;
+        else status = StatusEL::TIMEOUT;
+        this->setSample(samples[0], 0, distance, status, millis());
+        this->measuring = false;
+        n = 1;
+      }
+      // start the next measurement (this fails, and is retried by the
+      // next call, if the sensor still sends the previous echo)
+      this->measuring = this->hcsr04.trigger();
+      return n;
+    };
+  private:
+    HCSR04 &hcsr04;
+    bool measuring = false;
+};
+#endif
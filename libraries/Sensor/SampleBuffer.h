@@ -0,0 +1,109 @@
+#ifndef SampleBuffer_h
+#define SampleBuffer_h
+
+#include "Sensor.h"
+
+// Compiler memory barrier: stops the compiler from moving the sample
+// memory accesses after/before the head and tail updates. AVR MCUs
+// don't reorder memory accesses, so nothing else is needed.
+#define SAMPLE_BUFFER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * Lock-free single-producer/single-consumer ring buffer of samples.
+ * The producer (e.g., an interrupt routine) only writes the head,
+ * and the consumer (e.g., loop()) only writes the tail, so no
+ * interrupts disabling is needed.
+ * @param Size
+ *          the buffer capacity, a power of 2, maximum 128
+ */
+template <uint8_t Size>
+class SampleBuffer {
+  static_assert(Size > 0 && Size <= 128 && (Size & (Size - 1)) == 0,
+    "SampleBuffer size must be a power of 2, maximum 128");
+  public:
+    SampleBuffer() {
+      this->head = 0;
+      this->tail = 0;
+      this->dropped = 0;
+    };
+    /**
+     * Add a sample (producer side).
+     * @param sample
+     *          the sample to add
+     * @return true if the sample was added, false if the buffer is full
+     */
+    bool push(const Sensor::Sample &sample) {
+      uint8_t head = this->head;
+      if ((uint8_t)(head - this->tail) >= Size) {
+        if (this->dropped < 255) this->dropped++;
+        return false;
+      }
+      this->buffer[head & (Size - 1)] = sample;
+      SAMPLE_BUFFER_BARRIER();
+      this->head = head + 1;
+      return true;
+    };
+    /**
+     * Add the samples of a sensor reading (producer side).
+     * @param samples
+     *          the samples to add
+     * @param n
+     *          the number of samples
+     * @return the number of added samples
+     */
+    uint8_t push(const Sensor::Sample samples[], uint8_t n) {
+      uint8_t i = 0;
+      while (i < n && this->push(samples[i])) i++;
+      return i;
+    };
+    /**
+     * Remove the oldest sample (consumer side).
+     * @param sample
+     *          reference parameter storing the removed sample
+     * @return true if a sample was removed, false if the buffer is empty
+     */
+    bool pop(Sensor::Sample &sample) {
+      uint8_t tail = this->tail;
+      if (tail == this->head) return false;
+      // the sample must be read after the head
+      SAMPLE_BUFFER_BARRIER();
+      sample = this->buffer[tail & (Size - 1)];
+      SAMPLE_BUFFER_BARRIER();
+      this->tail = tail + 1;
+      return true;
+    };
+    /**
+     * Get a buffered sample, without removing it (consumer side).
+     * @param index
+     *          the sample index, 0 is the oldest one
+     * @return a pointer to the sample, or 0 if there is no such sample.
+     */
+    const Sensor::Sample* peek(uint8_t index = 0) {
+      if (index >= this->count()) return 0;
+      SAMPLE_BUFFER_BARRIER();
+      return &this->buffer[(uint8_t)(this->tail + index) & (Size - 1)];
+    };
+    /**
+     * Remove the oldest samples (consumer side), e.g.,
+     * after they were processed by using peek.
+     * @param n
+     *          the number of samples to remove
+     */
+    void drop(uint8_t n) {
+      if (n > this->count()) n = this->count();
+      SAMPLE_BUFFER_BARRIER();
+      this->tail = this->tail + n;
+    };
+    uint8_t count() { return this->head - this->tail; };
+    bool isEmpty() { return this->head == this->tail; };
+    bool isFull() { return this->count() >= Size; };
+    // number of samples lost because the buffer was full (at most 255:
+    // 8 bits, so it is read atomically while the producer updates it)
+    uint8_t getDropped() { return this->dropped; };
+  private:
+    Sensor::Sample buffer[Size];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint8_t dropped;
+};
+#endif
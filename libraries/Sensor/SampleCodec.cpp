@@ -0,0 +1,175 @@
+#include "SampleCodec.h"
+
+/**
+ * Zig-zag encoding: map signed values to unsigned values,
+ * such that small absolute values give small results.
+ */
+static inline uint32_t zigzagEncode(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+};
+
+static inline int32_t zigzagDecode(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+};
+
+/**
+ * Constructor.
+ * @param buffer
+ *          the buffer where the batch is encoded
+ * @param size
+ *          the buffer size
+ */
+SampleEncoder::SampleEncoder(uint8_t *buffer, uint16_t size) {
+  this->buffer = buffer;
+  this->size = size;
+  this->begin(0);
+};
+
+/**
+ * Start a new batch (the buffer data is discarded).
+ * @param timestamp
+ *          the base timestamp, e.g., the timestamp of the first sample
+ */
+void SampleEncoder::begin(uint32_t timestamp) {
+  this->length = 0;
+  this->count = 0;
+  this->timestamp = timestamp;
+  for (uint8_t i = 0; i < SAMPLE_CODEC_MAX_CHANNELS; i++) this->values[i] = 0;
+  if (this->size > 0) this->buffer[this->length++] = SAMPLE_CODEC_VERSION;
+  this->putVarint(timestamp);
+};
+
+/**
+ * Write a byte in the buffer.
+ * @param value
+ *          the value to write
+ * @return true if the value was written, false if the buffer is full
+ */
+bool SampleEncoder::putByte(uint8_t value) {
+  if (this->length >= this->size) return false;
+  this->buffer[this->length++] = value;
+  return true;
+};
+
+/**
+ * Write a varint in the buffer.
+ * @param value
+ *          the value to write
+ * @return true if the value was written, false if the buffer is full
+ */
+bool SampleEncoder::putVarint(uint32_t value) {
+  do {
+    if (this->length >= this->size) return false;
+    this->buffer[this->length++] = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+    value >>= 7;
+  } while (value);
+  return true;
+};
+
+/**
+ * Add a sample to the batch. The samples must be added
+ * in chronological order.
+ * @param sample
+ *          the sample to add
+ * @return true if the sample was added, false if the buffer
+ *         is full (the batch data is left unchanged) or the
+ *         channel is not supported
+ */
+bool SampleEncoder::add(const Sensor::Sample &sample) {
+  uint16_t length = this->length;
+  uint32_t delta = 0;
+  bool ok = true;
+  if (sample.channel >= SAMPLE_CODEC_MAX_CHANNELS) return false;
+  // unsigned math: the difference of two int32 values may overflow,
+  // so the delta wraps around (and the decoder wraps it back)
+  delta = (uint32_t)sample.value - (uint32_t)this->values[sample.channel];
+  if (sample.status == Sensor::StatusEL::OK) {
+    ok = this->putByte(sample.channel)
+      && this->putVarint(sample.timestamp - this->timestamp)
+      && this->putVarint(zigzagEncode((int32_t)delta));
+  } else {
+    ok = this->putByte(sample.channel | SAMPLE_CODEC_STATUS_FLAG)
+      && this->putVarint(sample.timestamp - this->timestamp)
+      && this->putVarint((uint8_t)sample.status);
+  }
+  // no more space: drop the partially written sample
+  if (!ok) {
+    this->length = length;
+    return false;
+  }
+  this->timestamp = sample.timestamp;
+  if (sample.status == Sensor::StatusEL::OK)
+    this->values[sample.channel] = sample.value;
+  this->count++;
+  return true;
+};
+
+/**
+ * Constructor.
+ * @param data
+ *          the encoded batch
+ * @param length
+ *          the encoded batch length
+ */
+SampleDecoder::SampleDecoder(const uint8_t *data, uint16_t length) {
+  uint32_t timestamp = 0;
+  this->data = data;
+  this->length = length;
+  this->position = 0;
+  for (uint8_t i = 0; i < SAMPLE_CODEC_MAX_CHANNELS; i++) this->values[i] = 0;
+  this->valid = length > 0 && data[this->position++] == SAMPLE_CODEC_VERSION
+    && this->getVarint(timestamp);
+  this->timestamp = timestamp;
+};
+
+/**
+ * Read a varint from the data.
+ * @param value
+ *          reference parameter storing the read value
+ * @return true if a value was read, false if the data is truncated
+ */
+bool SampleDecoder::getVarint(uint32_t &value) {
+  uint8_t shift = 0, c = 0;
+  value = 0;
+  do {
+    if (this->position >= this->length || shift > 28) return false;
+    c = this->data[this->position++];
+    value |= (uint32_t)(c & 0x7F) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  return true;
+};
+
+/**
+ * Decode the next sample.
+ * @param sample
+ *          reference parameter storing the decoded sample
+ * @return true if a sample was decoded, false at the end
+ *         of the data or if the data is invalid
+ */
+bool SampleDecoder::next(Sensor::Sample &sample) {
+  uint32_t delta = 0, value = 0;
+  uint8_t channel = 0;
+  if (!this->valid || this->position >= this->length) return false;
+  channel = this->data[this->position++];
+  if (!this->getVarint(delta)
+    || !this->getVarint(value)
+    || (channel & ~SAMPLE_CODEC_STATUS_FLAG) >= SAMPLE_CODEC_MAX_CHANNELS) {
+    this->valid = false;
+    return false;
+  }
+  this->timestamp += delta;
+  sample.timestamp = this->timestamp;
+  sample.channel = channel & ~SAMPLE_CODEC_STATUS_FLAG;
+  if (channel & SAMPLE_CODEC_STATUS_FLAG) {
+    sample.status = (Sensor::StatusEL)value;
+    sample.value = this->values[sample.channel];
+  } else {
+    sample.status = Sensor::StatusEL::OK;
+    // unsigned math, as for the encoded delta
+    this->values[sample.channel] = (int32_t)(
+      (uint32_t)this->values[sample.channel] + (uint32_t)zigzagDecode(value));
+    sample.value = this->values[sample.channel];
+  }
+  return true;
+};
@@ -0,0 +1,65 @@
+#ifndef SampleCodec_h
+#define SampleCodec_h
+
+#include "Sensor.h"
+
+// Maximum number of channels: channels 0 to
+// SAMPLE_CODEC_MAX_CHANNELS - 1 can be encoded.
+#define SAMPLE_CODEC_MAX_CHANNELS 8
+// Format version, the first byte of every batch.
+#define SAMPLE_CODEC_VERSION 1
+// Channel byte flag: the sample status is not OK, and the
+// channel is followed by the status (varint) instead of the value.
+#define SAMPLE_CODEC_STATUS_FLAG 0x80
+
+/**
+ * Compact binary encoding for batches of samples:
+ *   - header: version byte, base timestamp (varint)
+ *   - every sample: channel byte (one byte, SAMPLE_CODEC_STATUS_FLAG
+ *     is set for the status samples), timestamp delta relative to the
+ *     previous sample (varint), value delta relative to the previous
+ *     value of the same channel (zig-zag varint)
+ * A varint uses 7 bits per byte, the high bit is set for all the
+ * bytes except the last one. Zig-zag maps the signed deltas to
+ * unsigned values (0, -1, 1, -2... become 0, 1, 2, 3...), so small
+ * changes need only one byte. A sample of a slowly changing sensor,
+ * read periodically, usually needs 3-4 bytes.
+ */
+class SampleEncoder {
+  public:
+    SampleEncoder(uint8_t *buffer, uint16_t size);
+    void begin(uint32_t timestamp);
+    bool add(const Sensor::Sample &sample);
+    const uint8_t* getData() { return this->buffer; };
+    uint16_t getLength() { return this->length; };
+    uint16_t getCount() { return this->count; };
+  private:
+    uint8_t *buffer;
+    uint16_t size;
+    uint16_t length;
+    uint16_t count;
+    uint32_t timestamp;
+    int32_t values[SAMPLE_CODEC_MAX_CHANNELS];
+    bool putByte(uint8_t value);
+    bool putVarint(uint32_t value);
+};
+
+/**
+ * Decoder for the SampleEncoder batches. Works on the Arduino
+ * boards as well as on the host (server) side.
+ */
+class SampleDecoder {
+  public:
+    SampleDecoder(const uint8_t *data, uint16_t length);
+    bool next(Sensor::Sample &sample);
+    bool isValid() { return this->valid; };
+  private:
+    const uint8_t *data;
+    uint16_t length;
+    uint16_t position;
+    bool valid;
+    uint32_t timestamp;
+    int32_t values[SAMPLE_CODEC_MAX_CHANNELS];
+    bool getVarint(uint32_t &value);
+};
+#endif
@@ -0,0 +1,95 @@
+#ifndef Sensor_h
+#define Sensor_h
+
+#if ARDUINO < 100
+#include <WProgram.h>
+#include <pins_arduino.h>
+#else
+#include <Arduino.h>
+#endif
+
+/**
+ * Common interface for all the sensors. Every sensor provides one
+ * or more channels (e.g., DHT22 has temperature and humidity), and
+ * every reading of a channel is a Sample: a status, a fixed-point
+ * value and a timestamp. The value scale depends on the channel:
+ *   - DhtSensor: hundredths of Celsius degree and of %RH
+ *   - HCSR04Sensor: millimeters
+ *   - AnalogSensor: raw ADC value (10 + oversampling bits)
+ */
+class Sensor {
+  public:
+    // Sample statuses.
+    enum class StatusEL: unsigned char {
+      // NONE ==> no reading performed yet
+      NONE = 0,
+      // BUSY ==> reading in progress
+      BUSY = 1,
+      // OK ==> valid value
+      OK = 2,
+      // ERROR ==> invalid data received from the sensor (e.g., CRC error)
+      ERROR = 4,
+      // TIMEOUT ==> the sensor does not communicate
+      TIMEOUT = 8,
+      // OUT_OF_RANGE ==> the measured value is outside of the sensor range
+      OUT_OF_RANGE = 16
+    };
+    // One reading of a sensor channel.
+    struct Sample {
+      // reading time (see millis()), always 32 bits, such that
+      // it wraps in the same way on the MCU and on the host
+      uint32_t timestamp = 0;
+      // fixed-point value (the scale depends on the channel)
+      int32_t value = 0;
+      // the channel, unique in the application (see Sensor constructor)
+      uint8_t channel = 0;
+      // sample status
+      StatusEL status = StatusEL::NONE;
+    };
+    /**
+     * Constructor.
+     * @param channel
+     *          the channel of the first sensor value. The next
+     *          values use the next channels (channel + 1, etc).
+     */
+    Sensor(uint8_t channel) {
+      this->channel = channel;
+    };
+    /**
+     * Get the number of channels (values) provided by the sensor.
+     * @return the number of channels
+     */
+    virtual uint8_t getChannels() = 0;
+    /**
+     * Read the sensor.
+     * @param samples
+     *          array with space for (at least) getChannels() samples
+     * @return the number of samples stored in the array, which can
+     *         be 0 for non-blocking sensors, if no new reading is
+     *         available yet.
+     */
+    virtual uint8_t read(Sample samples[]) = 0;
+  protected:
+    uint8_t channel;
+    /**
+     * Fill in a sample.
+     * @param sample
+     *          the sample to fill in
+     * @param index
+     *          the index of the sensor channel (0 for the first one)
+     * @param value
+     *          the sample value
+     * @param status
+     *          the sample status
+     * @param timestamp
+     *          the sample timestamp
+     */
+    void setSample(Sample &sample, uint8_t index, int32_t value,
+      StatusEL status, uint32_t timestamp) {
+      sample.timestamp = timestamp;
+      sample.value = value;
+      sample.channel = this->channel + index;
+      sample.status = status;
+    };
+};
+#endif
@@ -0,0 +1,45 @@
+#include "Sensor.h"
+#include "SampleBuffer.h"
+#include "DhtSensor.h"
+#include "HCSR04Sensor.h"
+#define DHT_PIN 7
+#define TRIGGER_PIN 6
+#define ECHO_PIN 5
+
+Dht dht(DHT_PIN, Dht::TypeEL::DHT22);
+HCSR04 hcsr04(TRIGGER_PIN, ECHO_PIN);
+// DHT22: channels 0 (temperature) and 1 (humidity)
+DhtSensor dhtSensor(dht, 0);
+// HCSR04: channel 2 (distance)
+HCSR04Sensor distanceSensor(hcsr04, 2);
+Sensor *sensors[] = {&dhtSensor, &distanceSensor};
+SampleBuffer<16> samples;
+
+void setup() {
+  // Start serial communication, used to show
+  // sensor data in the Arduino serial monitor.
+  Serial.begin(115200);
+  // Wait for the sensors to settle.
+  delay(2500);
+}
+
+void loop() {
+  Sensor::Sample data[2];
+  uint8_t n = 0;
+  Sensor::Sample sample;
+  // read all the sensors, in the same way, and store the samples
+  for (uint8_t i = 0; i < 2; i++) {
+    n = sensors[i]->read(data);
+    samples.push(data, n);
+  }
+  // somewhere else (or later), the samples are used
+  while (samples.pop(sample)) {
+    if (sample.status != Sensor::StatusEL::OK) continue;
+    Serial.print(sample.timestamp);
+    Serial.print(": channel ");
+    Serial.print(sample.channel);
+    Serial.print(" = ");
+    Serial.println(sample.value);
+  }
+  delay(100);
+}
@@ -0,0 +1,94 @@
+#include "Trace.h"
+#include <util/atomic.h>
+
+Trace::Event Trace::events[TRACE_BUFFER_SIZE];
+volatile uint8_t Trace::head = 0;
+volatile uint8_t Trace::count = 0;
+volatile uint16_t Trace::dropped = 0;
+
+/**
+ * Store an event. Safe to use from interrupt routines.
+ * NOTE: use the TRACE macro instead, so the call is removed
+ *       when the tracing is disabled (TRACE_ENABLED is 0).
+ * @param id
+ *          the event ID (TRACE_EV_XXX value, or TRACE_EV_USER + n)
+ * @param arg
+ *          the event argument (meaning depends on the event)
+ */
+void Trace::record(uint8_t id, uint16_t arg) {
+  uint32_t time = micros();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    Event &event = Trace::events[Trace::head];
+    event.id = id;
+    event.time = time;
+    event.arg = arg;
+    Trace::head = (Trace::head + 1) % TRACE_BUFFER_SIZE;
+    if (Trace::count < TRACE_BUFFER_SIZE) Trace::count++;
+    else if (Trace::dropped < 0xFFFF) Trace::dropped++;
+  }
+};
+
+/**
+ * Send the stored events (oldest first) and clear the buffer.
+ * The format is binary, little endian: "TRC", the format version (1),
+ * the events count (1 byte), the dropped events count (2 bytes), then
+ * for every event: ID (1 byte), micros() time (4 bytes), argument
+ * (2 bytes). Use tools/trace_timeline.py to show it as a timeline.
+ * NOTE: the events recorded while dumping are kept for the next dump.
+ * @param out
+ *          where to send the events (e.g., a debug SoftwareSerial)
+ * @return the number of events sent
+ */
+uint8_t Trace::dump(Print &out) {
+  uint8_t n = 0, first = 0;
+  uint16_t lost = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    n = Trace::count;
+    lost = Trace::dropped;
+    first = (Trace::head + TRACE_BUFFER_SIZE - n) % TRACE_BUFFER_SIZE;
+  }
+  out.write((const uint8_t*)"TRC\x01", 4);
+  out.write(n);
+  Trace::write(out, lost, 2);
+  for (uint8_t i = 0; i < n; i++) {
+    Event event;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      event = Trace::events[(first + i) % TRACE_BUFFER_SIZE];
+    }
+    out.write(event.id);
+    Trace::write(out, event.time, 4);
+    Trace::write(out, event.arg, 2);
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    // keep only the events recorded while sending
+    Trace::count = Trace::count > n ? Trace::count - n : 0;
+    Trace::dropped -= lost;
+  }
+  return n;
+};
+
+/**
+ * Remove all the stored events.
+ */
+void Trace::clear() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    Trace::count = 0;
+    Trace::dropped = 0;
+  }
+};
+
+/**
+ * Send a value, little endian.
+ * @param out
+ *          where to send the value
+ * @param value
+ *          the value to send
+ * @param size
+ *          number of bytes to send
+ */
+void Trace::write(Print &out, uint32_t value, uint8_t size) {
+  for (uint8_t i = 0; i < size; i++) {
+    out.write((uint8_t)value);
+    value >>= 8;
+  }
+};
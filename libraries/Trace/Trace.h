@@ -0,0 +1,90 @@
+#ifndef Trace_h
+#define Trace_h
+
+#if ARDUINO < 100
+#include <WProgram.h>
+#include <pins_arduino.h>
+#else
+#include <Arduino.h>
+#endif
+
+// Set to 1 to record the trace events. Arduino compiles the libraries
+// without the sketch defines, so change the value here (or use a build
+// flag, e.g., -DTRACE_ENABLED=1). When 0, the TRACE calls are removed
+// by the preprocessor, so they cost neither flash, RAM nor time.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+// Number of stored events (7 bytes RAM each). When the buffer is full,
+// the oldest events are overwritten (and counted as dropped).
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 32
+#endif
+
+// Event IDs used by the libraries (the argument is shown in brackets).
+// The host tool (tools/trace_timeline.py) reads the names from here.
+// ATTransport: start waiting for a response [timeout, ms]
+#define TRACE_EV_AT_WAIT_START 1
+// ATTransport: end of the wait [0 = response found, 1 = timeout]
+#define TRACE_EV_AT_WAIT_END 2
+// ESP8266: +IPD header received [announced data length]
+#define TRACE_EV_IPD_START 3
+// ESP8266: +IPD data received [received data length]
+#define TRACE_EV_IPD_END 4
+// DHTxx: end of the data request [1 = sensor ready, 0 = timeout]
+#define TRACE_EV_DHT_READY 5
+// DHTxx: data bit timeout [bit index in the byte, 0 = MSB]
+#define TRACE_EV_DHT_BIT_TIMEOUT 6
+// HCSR04: blocking measurement done [echo duration, us, 0 = no echo]
+#define TRACE_EV_HCSR04_ECHO 7
+// ESP8266Link: the link is down [time since the last proof of life, ms]
+#define TRACE_EV_LINK_DOWN 8
+// ESP8266Link: recovery step [ladder level, see ESP8266Link::Level]
+#define TRACE_EV_LINK_STEP 9
+// ESP8266Link: the link is up again [recovery time, ms]
+#define TRACE_EV_LINK_UP 10
+// First ID free for the sketch events (128-255).
+#define TRACE_EV_USER 128
+
+#if TRACE_ENABLED
+#define TRACE(id, arg) Trace::record((id), (arg))
+#else
+#define TRACE(id, arg) ((void)0)
+#endif
+
+/**
+ * Ring buffer of timestamped events, e.g., to find out where the time
+ * goes in a blocking read or why a response was missed. Use the TRACE
+ * macro to record events, so they are compiled only if TRACE_ENABLED
+ * is 1, and Trace::dump to send the stored events to the host.
+ */
+class Trace {
+  public:
+    static void record(uint8_t id, uint16_t arg);
+    static uint8_t dump(Print &out);
+    static void clear();
+    /**
+     * Get the number of stored events.
+     */
+    static uint8_t getCount() {
+      return Trace::count;
+    };
+    /**
+     * Get the number of events overwritten (lost) since the last dump.
+     */
+    static uint16_t getDropped() {
+      return Trace::dropped;
+    };
+  private:
+    struct Event {
+      uint8_t id;
+      uint32_t time;
+      uint16_t arg;
+    };
+    static Event events[TRACE_BUFFER_SIZE];
+    static volatile uint8_t head;
+    static volatile uint8_t count;
+    static volatile uint16_t dropped;
+    static void write(Print &out, uint32_t value, uint8_t size);
+};
+#endif
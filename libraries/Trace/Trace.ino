@@ -0,0 +1,39 @@
+#include <SoftwareSerial.h>
+#include "Trace.h"
+#include "DHTxx.h"
+#include "HCSR04.h"
+#define DHT_PIN 7
+#define TRIGGER_PIN 6
+#define ECHO_PIN 5
+// a sketch event: the loop duration
+#define TRACE_EV_LOOP TRACE_EV_USER
+
+// NOTE: set TRACE_ENABLED to 1 in Trace.h, otherwise no events are recorded.
+Dht dht(DHT_PIN, Dht::TypeEL::DHT22);
+HCSR04 hcsr04(TRIGGER_PIN, ECHO_PIN);
+// the trace is sent to the PC via a USB-to-serial adapter
+SoftwareSerial debug(10, 11);
+
+void setup() {
+  Serial.begin(115200);
+  debug.begin(57600);
+  // Wait for the sensors to settle.
+  delay(2500);
+};
+
+void loop() {
+  unsigned long start = millis();
+  Dht::Result result = dht.read();
+  float distance = hcsr04.read();
+  TRACE(TRACE_EV_LOOP, millis() - start);
+  Serial.print(result.temperature);
+  Serial.print(" ");
+  Serial.println(distance);
+  // send the recorded events every 8 loops (the buffer stores 32 events)
+  static uint8_t loops = 0;
+  if (++loops == 8) {
+    Trace::dump(debug);
+    loops = 0;
+  }
+  delay(2000);
+};
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Show the events sent by Trace::dump as a timeline.
+
+The input is a capture of the debug serial port (e.g., saved with
+"cat /dev/ttyUSB0 > trace.bin" or a terminal program), which may also
+contain text and more than one dump. The event names are read from
+Trace.h, so the sketch events (TRACE_EV_USER + n) can be named there too.
+
+Usage: trace_timeline.py [-c] capture.bin [Trace.h]
+  -c  output CSV (dump, time, delta, event, argument) instead of text
+"""
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"TRC\x01"
+HEADER = struct.Struct("<BH")
+EVENT = struct.Struct("<BIH")
+
+
+def load_names(header):
+    names = {}
+    with open(header) as f:
+        for match in re.finditer(r"#define\s+TRACE_EV_(\w+)\s+(\d+)", f.read()):
+            names[int(match.group(2))] = match.group(1)
+    return names
+
+
+def event_name(names, eid):
+    if eid >= 128:
+        return names.get(eid, "USER+%d" % (eid - 128))
+    return names.get(eid, "EVENT_%d" % eid)
+
+
+def parse(data):
+    """Yield (dropped, [(id, time, arg), ...]) for every dump found."""
+    pos = data.find(MAGIC)
+    while pos >= 0:
+        start = pos + len(MAGIC)
+        if start + HEADER.size > len(data):
+            break
+        count, dropped = HEADER.unpack_from(data, start)
+        start += HEADER.size
+        if start + count * EVENT.size > len(data):
+            sys.stderr.write("truncated dump at offset %d\n" % pos)
+            break
+        events = [EVENT.unpack_from(data, start + i * EVENT.size)
+                  for i in range(count)]
+        yield dropped, events
+        pos = data.find(MAGIC, start + count * EVENT.size)
+
+
+def main(argv):
+    csv = "-c" in argv
+    args = [a for a in argv if a != "-c"]
+    if not args:
+        sys.stderr.write(__doc__)
+        return 1
+    header = args[1] if len(args) > 1 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "Trace.h")
+    names = load_names(header)
+    with open(args[0], "rb") as f:
+        data = f.read()
+    if csv:
+        print("dump,time_us,delta_us,event,arg")
+    for n, (dropped, events) in enumerate(parse(data)):
+        if not csv:
+            print("dump %d: %d events, %d dropped" % (n, len(events), dropped))
+        if not events:
+            continue
+        # micros() wraps every ~71 minutes: the times are unsigned
+        # 32 bits, so the differences are computed modulo 2^32
+        first = prev = events[0][1]
+        for eid, time, arg in events:
+            rel = (time - first) & 0xFFFFFFFF
+            delta = (time - prev) & 0xFFFFFFFF
+            prev = time
+            name = event_name(names, eid)
+            if csv:
+                print("%d,%d,%d,%s,%d" % (n, rel, delta, name, arg))
+            else:
+                print("%12.3f ms  +%9d us  %-16s %d"
+                      % (rel / 1000.0, delta, name, arg))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
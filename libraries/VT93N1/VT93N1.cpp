@@ -0,0 +1,102 @@
+#include "VT93N1.h"
+
+// ADC value (10 bits) to lux lookup tables. All the
+// values are computed at compile time, see VT93N1.h.
+static_assert(VT93N1_FINE_START == 928,
+  "the lookup tables are written for VT93N1_FINE_START = 928");
+// One entry for every 16 ADC units, up to VT93N1_FINE_START.
+const uint16_t VT93N1_LUX_COARSE[VT93N1_COARSE_SIZE] PROGMEM = {
+  vt93n1::entry(0), vt93n1::entry(16), vt93n1::entry(32), vt93n1::entry(48),
+  vt93n1::entry(64), vt93n1::entry(80), vt93n1::entry(96), vt93n1::entry(112),
+  vt93n1::entry(128), vt93n1::entry(144), vt93n1::entry(160), vt93n1::entry(176),
+  vt93n1::entry(192), vt93n1::entry(208), vt93n1::entry(224), vt93n1::entry(240),
+  vt93n1::entry(256), vt93n1::entry(272), vt93n1::entry(288), vt93n1::entry(304),
+  vt93n1::entry(320), vt93n1::entry(336), vt93n1::entry(352), vt93n1::entry(368),
+  vt93n1::entry(384), vt93n1::entry(400), vt93n1::entry(416), vt93n1::entry(432),
+  vt93n1::entry(448), vt93n1::entry(464), vt93n1::entry(480), vt93n1::entry(496),
+  vt93n1::entry(512), vt93n1::entry(528), vt93n1::entry(544), vt93n1::entry(560),
+  vt93n1::entry(576), vt93n1::entry(592), vt93n1::entry(608), vt93n1::entry(624),
+  vt93n1::entry(640), vt93n1::entry(656), vt93n1::entry(672), vt93n1::entry(688),
+  vt93n1::entry(704), vt93n1::entry(720), vt93n1::entry(736), vt93n1::entry(752),
+  vt93n1::entry(768), vt93n1::entry(784), vt93n1::entry(800), vt93n1::entry(816),
+  vt93n1::entry(832), vt93n1::entry(848), vt93n1::entry(864), vt93n1::entry(880),
+  vt93n1::entry(896), vt93n1::entry(912), vt93n1::entry(928)
+};
+// One entry for every ADC unit, from VT93N1_FINE_START.
+const uint16_t VT93N1_LUX_FINE[VT93N1_FINE_SIZE] PROGMEM = {
+  vt93n1::entry(928), vt93n1::entry(929), vt93n1::entry(930), vt93n1::entry(931),
+  vt93n1::entry(932), vt93n1::entry(933), vt93n1::entry(934), vt93n1::entry(935),
+  vt93n1::entry(936), vt93n1::entry(937), vt93n1::entry(938), vt93n1::entry(939),
+  vt93n1::entry(940), vt93n1::entry(941), vt93n1::entry(942), vt93n1::entry(943),
+  vt93n1::entry(944), vt93n1::entry(945), vt93n1::entry(946), vt93n1::entry(947),
+  vt93n1::entry(948), vt93n1::entry(949), vt93n1::entry(950), vt93n1::entry(951),
+  vt93n1::entry(952), vt93n1::entry(953), vt93n1::entry(954), vt93n1::entry(955),
+  vt93n1::entry(956), vt93n1::entry(957), vt93n1::entry(958), vt93n1::entry(959),
+  vt93n1::entry(960), vt93n1::entry(961), vt93n1::entry(962), vt93n1::entry(963),
+  vt93n1::entry(964), vt93n1::entry(965), vt93n1::entry(966), vt93n1::entry(967),
+  vt93n1::entry(968), vt93n1::entry(969), vt93n1::entry(970), vt93n1::entry(971),
+  vt93n1::entry(972), vt93n1::entry(973), vt93n1::entry(974), vt93n1::entry(975),
+  vt93n1::entry(976), vt93n1::entry(977), vt93n1::entry(978), vt93n1::entry(979),
+  vt93n1::entry(980), vt93n1::entry(981), vt93n1::entry(982), vt93n1::entry(983),
+  vt93n1::entry(984), vt93n1::entry(985), vt93n1::entry(986), vt93n1::entry(987),
+  vt93n1::entry(988), vt93n1::entry(989), vt93n1::entry(990), vt93n1::entry(991),
+  vt93n1::entry(992), vt93n1::entry(993), vt93n1::entry(994), vt93n1::entry(995),
+  vt93n1::entry(996), vt93n1::entry(997), vt93n1::entry(998), vt93n1::entry(999),
+  vt93n1::entry(1000), vt93n1::entry(1001), vt93n1::entry(1002), vt93n1::entry(1003),
+  vt93n1::entry(1004), vt93n1::entry(1005), vt93n1::entry(1006), vt93n1::entry(1007),
+  vt93n1::entry(1008), vt93n1::entry(1009), vt93n1::entry(1010), vt93n1::entry(1011),
+  vt93n1::entry(1012), vt93n1::entry(1013), vt93n1::entry(1014), vt93n1::entry(1015),
+  vt93n1::entry(1016), vt93n1::entry(1017), vt93n1::entry(1018), vt93n1::entry(1019),
+  vt93n1::entry(1020), vt93n1::entry(1021), vt93n1::entry(1022), vt93n1::entry(1023),
+  vt93n1::entry(1024)
+};
+
+/**
+ * Linear interpolation between two lookup table entries.
+ * @param table
+ *          the lookup table (stored in PROGMEM)
+ * @param index
+ *          the index of the lower entry
+ * @param fraction
+ *          the distance from the lower entry
+ * @param fractionBits
+ *          the number of bits of the fraction
+ * @return the interpolated value
+ */
+uint16_t VT93N1::interpolate(const uint16_t table[], uint16_t index,
+  uint16_t fraction, uint8_t fractionBits) {
+  uint16_t low = pgm_read_word(&table[index]);
+  uint16_t high = 0;
+  if (fraction == 0) return low;
+  high = pgm_read_word(&table[index + 1]);
+  // the table is monotonic: more light means higher ADC values
+  return low + (((uint32_t)(high - low) * fraction) >> fractionBits);
+};
+
+/**
+ * Convert an ADC value to lux, by using the lookup
+ * tables and linear interpolation (integer math only).
+ * @param adc
+ *          the ADC value measured across the R2 resistor
+ * @param resolution
+ *          the ADC value resolution, in bits: 10 for analogRead,
+ *          more if oversampling is used (see AnalogSampler), up to 16.
+ *          The values with less than 10 bits are scaled to 10 bits.
+ * @return the illuminance, in lux
+ */
+uint16_t VT93N1::toLux(uint16_t adc, uint8_t resolution) {
+  uint8_t extraBits = 0;
+  uint16_t fineStart = 0;
+  if (resolution < 10) {
+    adc <<= 10 - resolution;
+    resolution = 10;
+  } else if (resolution > 16) resolution = 16;
+  extraBits = resolution - 10;
+  fineStart = (uint16_t)VT93N1_FINE_START << extraBits;
+  if (adc < fineStart)
+    return VT93N1::interpolate(VT93N1_LUX_COARSE, adc >> (extraBits + 4),
+      adc & ((1 << (extraBits + 4)) - 1), extraBits + 4);
+  adc -= fineStart;
+  return VT93N1::interpolate(VT93N1_LUX_FINE, adc >> extraBits,
+    adc & ((1 << extraBits) - 1), extraBits);
+};
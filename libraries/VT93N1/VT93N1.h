@@ -0,0 +1,83 @@
+#ifndef VT93N1_h
+#define VT93N1_h
+
+#if ARDUINO < 100
+#include <WProgram.h>
+#include <pins_arduino.h>
+#else
+#include <Arduino.h>
+#endif
+#include <avr/pgmspace.h>
+
+// The sensor is used in a resistor divider: the VT93N1 (R1) is
+// connected to VIN, the R2 resistor to GND and the middle point
+// to the analog pin. Change the values below to match your circuit.
+// The lookup table is computed at compile time from these values.
+// R2 resistor value, in Ohm
+#define VT93N1_R2 10000.0
+// the divider supply voltage, in mV
+#define VT93N1_VIN 5000.0
+// the ADC reference voltage, in mV
+#define VT93N1_VREF 5000.0
+// The lux value grows very fast for high ADC values, so two lookup
+// tables are used: one entry for every 16 ADC units (10 bits) up
+// to VT93N1_FINE_START, then one entry for every ADC unit. With the
+// default circuit values, the interpolation error is below 1% or
+// 2.5 lux (whichever is larger) for every 10 bits ADC value; above
+// ADC 928 the curve is too steep for the 16 units step.
+// NOTE: the tables in VT93N1.cpp are written for this value, don't change it.
+#define VT93N1_FINE_START 928
+#define VT93N1_COARSE_SIZE (VT93N1_FINE_START / 16 + 1)
+#define VT93N1_FINE_SIZE (1024 - VT93N1_FINE_START + 1)
+// maximum reported value (for very bright light or shorted sensor)
+#define VT93N1_MAX_LUX 65535
+
+class VT93N1 {
+  public:
+    static uint16_t toLux(uint16_t adc, uint8_t resolution = 10);
+  private:
+    static uint16_t interpolate(const uint16_t table[], uint16_t index,
+      uint16_t fraction, uint8_t fractionBits);
+};
+
+/**
+ * Compile-time math used to compute the lookup table.
+ * NOTE: never use them at runtime, they are slow!
+ */
+namespace vt93n1 {
+  constexpr double LN2 = 0.69314718055994530942;
+  // atanh(y) = y + y^3/3 + y^5/5 + ...
+  constexpr double atanhSeries(double y2, double term, int k) {
+    return k > 41 ? 0 : term / k + atanhSeries(y2, term * y2, k + 2);
+  };
+  // ln(x) = 2 * atanh((x - 1) / (x + 1)), after range reduction to [0.5, 2]
+  constexpr double ln(double x) {
+    return x > 2 ? ln(x / 2) + LN2 : x < 0.5 ? ln(x * 2) - LN2
+      : 2 * atanhSeries(((x - 1) / (x + 1)) * ((x - 1) / (x + 1)),
+        (x - 1) / (x + 1), 1);
+  };
+  constexpr double square(double x) {
+    return x * x;
+  };
+  // exp(x) = 1 + x + x^2/2! + ..., after range reduction to [-0.5, 0.5]
+  constexpr double expSeries(double x, double term, int k) {
+    return k > 20 ? term : term + expSeries(x, term * x / k, k + 1);
+  };
+  constexpr double exp(double x) {
+    return (x > 0.5 || x < -0.5) ? square(exp(x / 2)) : expSeries(x, 1, 1);
+  };
+  // R1 resistance (in kOhm) for an ADC value (10 bits)
+  constexpr double r1(double adc) {
+    return VT93N1_R2 * (VT93N1_VIN * 1024 / (VT93N1_VREF * adc) - 1) / 1000;
+  };
+  // E = 341.64 / R^(10 / 9), where R is measured in kOhm
+  constexpr double lux(double r) {
+    return 341.64 * exp(-10.0 / 9.0 * ln(r));
+  };
+  constexpr uint16_t entry(uint16_t adc) {
+    return adc == 0 ? 0 : r1(adc) <= 0 ? VT93N1_MAX_LUX
+      : lux(r1(adc)) >= VT93N1_MAX_LUX ? VT93N1_MAX_LUX
+      : (uint16_t)(lux(r1(adc)) + 0.5);
+  };
+};
+#endif